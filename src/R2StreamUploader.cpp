@@ -0,0 +1,7 @@
+#include "R2StreamUploader.h"
+
+R2StreamUploader::R2StreamUploader(const R2::R2Config& config) : client_(config) {}
+
+bool R2StreamUploader::upload(const Interfaces::OutputReader& reader, const std::string& key) {
+    return client_.uploadStream(reader, key, "video/mp4");
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "interfaces/IStreamUploader.h"
+#include "r2_client.h"
+
+// Streams render output into an R2 (or any S3-compatible) multipart upload
+class R2StreamUploader : public Interfaces::IStreamUploader {
+public:
+    explicit R2StreamUploader(const R2::R2Config& config);
+    bool upload(const Interfaces::OutputReader& reader, const std::string& key) override;
+
+private:
+    R2::Client client_;
+};
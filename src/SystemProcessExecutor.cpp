@@ -129,3 +129,40 @@ void SystemProcessExecutor::executeWithProgress(const std::string& command, doub
         emitProgressEvent("encoding", "completed", 100.0, elapsed, 0.0, "Encoding complete");
     }
 }
+
+int SystemProcessExecutor::executeStreaming(const std::string& command,
+                                            const std::function<void(const Interfaces::OutputReader&)>& consume) {
+#if defined(_WIN32)
+    FILE* pipe = QVM_POPEN(command.c_str(), "rb");
+#else
+    FILE* pipe = QVM_POPEN(command.c_str(), "r");
+#endif
+    if (!pipe) {
+        throw std::runtime_error("Failed to start FFmpeg process");
+    }
+
+    // The exit status is collected at end of output, before the consumer can finish
+    // (e.g. complete an upload) with what might be a truncated stream
+    bool closed = false;
+    int status = 0;
+    Interfaces::OutputReader reader = [&](char* buffer, size_t size) -> size_t {
+        if (closed) return 0;
+        size_t count = fread(buffer, 1, size, pipe);
+        if (count == 0) {
+            closed = true;
+            status = QVM_PCLOSE(pipe);
+            if (status != 0) {
+                throw std::runtime_error("FFmpeg exited with status " + std::to_string(status));
+            }
+        }
+        return count;
+    };
+    try {
+        consume(reader);
+    } catch (...) {
+        if (!closed) QVM_PCLOSE(pipe);
+        throw;
+    }
+    // If the consumer stopped early, closing the pipe ends the writer with SIGPIPE
+    return closed ? status : QVM_PCLOSE(pipe);
+}
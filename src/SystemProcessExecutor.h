@@ -5,4 +5,6 @@ class SystemProcessExecutor : public Interfaces::IProcessExecutor {
 public:
     int execute(const std::string& command) override;
     void executeWithProgress(const std::string& command, double totalDurationSeconds) override;
+    int executeStreaming(const std::string& command,
+                         const std::function<void(const Interfaces::OutputReader&)>& consume) override;
 };
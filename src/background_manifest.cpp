@@ -0,0 +1,294 @@
+#include "background_manifest.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace BackgroundManifest {
+
+namespace {
+
+constexpr int kManifestVersion = 2;
+
+json paramsToJson(const OutputParams& params) {
+    json data = {
+        {"width", params.width},
+        {"height", params.height},
+        {"fps", params.fps},
+        {"crf", params.crf}
+    };
+    if (!params.overlay.empty()) data["overlay"] = params.overlay;
+    if (params.gopFrames > 0) data["gopFrames"] = params.gopFrames;
+    return data;
+}
+
+OutputParams paramsFromJson(const json& data) {
+    // Clips written before the manifest existed used the defaults
+    OutputParams params;
+    if (!data.is_object()) return params;
+    params.width = data.value("width", params.width);
+    params.height = data.value("height", params.height);
+    params.fps = data.value("fps", params.fps);
+    params.crf = data.value("crf", params.crf);
+    params.overlay = data.value("overlay", params.overlay);
+    params.gopFrames = data.value("gopFrames", params.gopFrames);
+    return params;
+}
+
+const std::regex kRenditionStem(R"(.*_std_\d+x\d+_\d+(_dim[0-9A-Za-z-]+)?)");
+
+// Overlay colors contain '@' and '.', which are awkward in object keys
+std::string overlayTag(const std::string& overlay) {
+    std::string tag;
+    for (char c : overlay) {
+        tag += std::isalnum(static_cast<unsigned char>(c)) ? c : '-';
+    }
+    return tag;
+}
+
+} // namespace
+
+std::vector<OutputParams> ClipEntry::ladder() const {
+    std::vector<OutputParams> result{params};
+    for (const auto& rendition : renditions) {
+        result.push_back(rendition.params);
+    }
+    return result;
+}
+
+std::string ClipEntry::outputFor(int width, int height, int fps, const std::string& overlay) const {
+    auto rendition = findRendition(width, height, fps, overlay);
+    return rendition ? rendition->output : "";
+}
+
+std::optional<Rendition> ClipEntry::findRendition(int width, int height, int fps, const std::string& overlay) const {
+    auto matches = [&](const OutputParams& candidate) {
+        return candidate.width == width && candidate.height == height && candidate.fps == fps &&
+               candidate.overlay == overlay;
+    };
+    if (matches(params)) return Rendition{output, params};
+    for (const auto& rendition : renditions) {
+        if (matches(rendition.params)) return rendition;
+    }
+    return std::nullopt;
+}
+
+std::vector<OutputParams> parseLadder(const std::string& spec, int defaultFps, int crf) {
+    static const std::regex entryPattern(R"(\s*(\d+)x(\d+)(?:@(\d+))?\s*)");
+    std::vector<OutputParams> ladder;
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::smatch match;
+        if (!std::regex_match(item, match, entryPattern)) {
+            throw std::invalid_argument("Invalid rendition '" + item + "' (expected WIDTHxHEIGHT[@FPS])");
+        }
+        OutputParams params;
+        params.width = std::stoi(match[1]);
+        params.height = std::stoi(match[2]);
+        params.fps = match[3].matched ? std::stoi(match[3]) : defaultFps;
+        params.crf = crf;
+        // libx264 with yuv420p needs even dimensions
+        if (params.width <= 0 || params.height <= 0 || params.fps <= 0 ||
+            params.width % 2 != 0 || params.height % 2 != 0) {
+            throw std::invalid_argument("Invalid rendition '" + item + "'");
+        }
+        if (std::find(ladder.begin(), ladder.end(), params) == ladder.end()) {
+            ladder.push_back(params);
+        }
+    }
+    if (ladder.empty()) {
+        throw std::invalid_argument("Rendition ladder is empty");
+    }
+    return ladder;
+}
+
+std::vector<OutputParams> withOverlays(const std::vector<OutputParams>& ladder,
+                                       const std::vector<std::string>& overlays) {
+    std::vector<OutputParams> result = ladder;
+    for (const auto& overlay : overlays) {
+        for (const auto& base : ladder) {
+            if (!base.overlay.empty()) continue;
+            OutputParams dimmed = base;
+            dimmed.overlay = overlay;
+            if (std::find(result.begin(), result.end(), dimmed) == result.end()) {
+                result.push_back(dimmed);
+            }
+        }
+    }
+    return result;
+}
+
+std::string outputFilename(const std::string& sourceStem, const OutputParams& params, bool primary) {
+    if (primary) return sourceStem + "_std.mp4";
+    std::string name = sourceStem + "_std_" + std::to_string(params.width) + "x" + std::to_string(params.height) +
+                       "_" + std::to_string(params.fps);
+    if (!params.overlay.empty()) name += "_dim" + overlayTag(params.overlay);
+    return name + ".mp4";
+}
+
+bool isRenditionVariant(const std::string& stem) {
+    return std::regex_match(stem, kRenditionStem);
+}
+
+Manifest Manifest::load(const fs::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return Manifest{};
+    }
+    try {
+        json data = json::parse(file);
+        return fromJson(data);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: Ignoring unreadable manifest " << path << ": " << e.what() << std::endl;
+        return Manifest{};
+    }
+}
+
+Manifest Manifest::fromJson(const json& data) {
+    Manifest manifest;
+    manifest.bucket = data.value("bucket", "");
+    manifest.standardizedAt = data.value("standardizedAt", "");
+    if (!data.contains("videos") || !data["videos"].is_array()) {
+        return manifest;
+    }
+
+    for (const auto& item : data["videos"]) {
+        if (!item.is_object()) continue;
+        ClipEntry entry;
+        entry.theme = item.value("theme", "");
+        std::string filename = item.value("filename", "");
+        entry.output = item.value("key", entry.theme.empty() ? filename : entry.theme + "/" + filename);
+        if (entry.output.empty()) continue;
+        entry.source = item.value("source", "");
+        entry.sourceHash = item.value("sourceHash", "");
+        entry.sourceSize = item.value("sourceSize", static_cast<std::uintmax_t>(0));
+        entry.sourceModified = item.value("sourceModified", 0LL);
+        entry.params = paramsFromJson(item.value("params", json::object()));
+        entry.duration = item.value("duration", 0.0);
+        entry.standardizedAt = item.value("standardizedAt", manifest.standardizedAt);
+        if (item.contains("renditions") && item["renditions"].is_array()) {
+            for (const auto& renditionItem : item["renditions"]) {
+                Rendition rendition;
+                rendition.output = renditionItem.value("key", "");
+                rendition.params = paramsFromJson(renditionItem.value("params", json::object()));
+                if (!rendition.output.empty()) entry.renditions.push_back(rendition);
+            }
+        }
+        manifest.upsert(std::move(entry));
+    }
+    return manifest;
+}
+
+json Manifest::toJson() const {
+    json data;
+    data["version"] = kManifestVersion;
+    if (!bucket.empty()) data["bucket"] = bucket;
+    data["standardizedAt"] = standardizedAt;
+
+    json videos = json::array();
+    for (const auto& [key, entry] : clips_) {
+        json item;
+        item["theme"] = entry.theme;
+        item["filename"] = fs::path(entry.output).filename().string();
+        item["key"] = entry.output;
+        item["duration"] = entry.duration;
+        item["params"] = paramsToJson(entry.params);
+        if (!entry.source.empty()) {
+            item["source"] = entry.source;
+            item["sourceHash"] = entry.sourceHash;
+            item["sourceSize"] = entry.sourceSize;
+            if (entry.sourceModified != 0) item["sourceModified"] = entry.sourceModified;
+        }
+        if (!entry.standardizedAt.empty()) item["standardizedAt"] = entry.standardizedAt;
+        if (!entry.renditions.empty()) {
+            json renditions = json::array();
+            for (const auto& rendition : entry.renditions) {
+                renditions.push_back({{"key", rendition.output}, {"params", paramsToJson(rendition.params)}});
+            }
+            item["renditions"] = renditions;
+        }
+        videos.push_back(item);
+    }
+    data["videos"] = videos;
+    data["totalVideos"] = clips_.size();
+    data["totalDuration"] = totalDuration();
+    return data;
+}
+
+void Manifest::save(const fs::path& path) const {
+    // Write to a sibling file first so an interrupted run never truncates the manifest
+    fs::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to write manifest: " + tempPath.string());
+        }
+        file << toJson().dump(2);
+    }
+    fs::rename(tempPath, path);
+}
+
+std::string Manifest::keyFor(const ClipEntry& entry) {
+    return entry.source.empty() ? entry.output : entry.source;
+}
+
+const ClipEntry* Manifest::findBySource(const std::string& source) const {
+    auto it = clips_.find(source);
+    return it != clips_.end() ? &it->second : nullptr;
+}
+
+const ClipEntry* Manifest::findByOutput(const std::string& output) const {
+    for (const auto& [key, entry] : clips_) {
+        if (entry.output == output) return &entry;
+    }
+    return nullptr;
+}
+
+void Manifest::upsert(ClipEntry entry) {
+    // A clip adopted by output name is superseded once its source is known
+    if (!entry.source.empty()) {
+        auto adopted = clips_.find(entry.output);
+        if (adopted != clips_.end() && adopted->second.source.empty()) {
+            clips_.erase(adopted);
+        }
+    }
+    std::string key = keyFor(entry);
+    clips_[key] = std::move(entry);
+}
+
+size_t Manifest::prune(const std::vector<std::string>& existingOutputs,
+                       const std::vector<std::string>& existingSources) {
+    std::set<std::string> outputs(existingOutputs.begin(), existingOutputs.end());
+    std::set<std::string> sources(existingSources.begin(), existingSources.end());
+    size_t removed = 0;
+    for (auto it = clips_.begin(); it != clips_.end();) {
+        bool hasOutput = outputs.count(it->second.output) > 0;
+        bool hasSource = !it->second.source.empty() && sources.count(it->second.source) > 0;
+        if (!hasOutput && !hasSource) {
+            it = clips_.erase(it);
+            removed++;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+double Manifest::totalDuration() const {
+    double total = 0.0;
+    for (const auto& [key, entry] : clips_) {
+        total += entry.duration;
+    }
+    return total;
+}
+
+} // namespace BackgroundManifest
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace BackgroundManifest {
+
+// Encoder parameters a standardized clip was produced with
+struct OutputParams {
+    int width = 1280;
+    int height = 720;
+    int fps = 30;
+    int crf = 23;
+    std::string overlay;  // ffmpeg color baked in as a full-frame dim (e.g. "0x000000@0.5"); empty = none
+    int gopFrames = 0;    // fixed keyframe interval; 0 = encoder default (not GOP-aligned)
+
+    bool operator==(const OutputParams& other) const {
+        return width == other.width && height == other.height &&
+               fps == other.fps && crf == other.crf && overlay == other.overlay &&
+               gopFrames == other.gopFrames;
+    }
+    bool operator!=(const OutputParams& other) const { return !(*this == other); }
+};
+
+// An additional size of a clip produced alongside the primary output
+struct Rendition {
+    std::string output;            // "theme/name_std_1920x1080_30.mp4"
+    OutputParams params;
+};
+
+// One standardized clip and the source it was produced from
+struct ClipEntry {
+    std::string theme;
+    std::string source;            // "theme/name.mov"; empty for clips adopted from older runs
+    std::string sourceHash;        // content hash of local sources, ETag for R2 objects
+    std::uintmax_t sourceSize = 0;
+    long long sourceModified = 0;  // local mtime, lets reruns skip rehashing unchanged files
+    std::string output;            // "theme/name_std.mp4"
+    OutputParams params;
+    double duration = 0.0;
+    std::string standardizedAt;
+    std::vector<Rendition> renditions;  // ladder entries after the primary output
+
+    // Primary params followed by every extra rendition, in ladder order
+    std::vector<OutputParams> ladder() const;
+
+    // Output whose size, frame rate and baked overlay match exactly; empty when none does
+    std::string outputFor(int width, int height, int fps, const std::string& overlay = "") const;
+    std::optional<Rendition> findRendition(int width, int height, int fps, const std::string& overlay = "") const;
+};
+
+// Parse "1920x1080,1280x720@25,1080x1920" (fps defaults to defaultFps).
+// Throws std::invalid_argument on malformed entries.
+std::vector<OutputParams> parseLadder(const std::string& spec, int defaultFps, int crf);
+
+// Append a pre-dimmed copy of every rendition for each overlay color
+std::vector<OutputParams> withOverlays(const std::vector<OutputParams>& ladder,
+                                       const std::vector<std::string>& overlays);
+
+// "name_std.mp4" for the primary rendition, "name_std_1920x1080_30.mp4" for the rest
+// ("name_std_1920x1080_30_dim0x000000-0-5.mp4" when an overlay is baked in)
+std::string outputFilename(const std::string& sourceStem, const OutputParams& params, bool primary);
+
+// True for extra renditions, which are picked through the manifest rather than listed directly
+bool isRenditionVariant(const std::string& stem);
+
+// Persistent record of every standardized clip (metadata.json at the library root).
+// Entries are keyed by source so reruns only touch new or changed clips.
+class Manifest {
+public:
+    // Missing or unreadable files yield an empty manifest
+    static Manifest load(const std::filesystem::path& path);
+    static Manifest fromJson(const nlohmann::json& data);
+
+    nlohmann::json toJson() const;
+    void save(const std::filesystem::path& path) const;
+
+    const ClipEntry* findBySource(const std::string& source) const;
+    const ClipEntry* findByOutput(const std::string& output) const;
+    void upsert(ClipEntry entry);
+
+    // Drop entries whose output no longer exists and cannot be rebuilt
+    size_t prune(const std::vector<std::string>& existingOutputs,
+                 const std::vector<std::string>& existingSources);
+
+    const std::map<std::string, ClipEntry>& clips() const { return clips_; }
+    double totalDuration() const;
+
+    std::string bucket;
+    std::string standardizedAt;
+
+private:
+    static std::string keyFor(const ClipEntry& entry);
+    std::map<std::string, ClipEntry> clips_;
+};
+
+} // namespace BackgroundManifest
@@ -7,6 +7,9 @@
 #include <sstream>
 #include <algorithm>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <set>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -16,6 +19,53 @@ namespace fs = std::filesystem;
 
 namespace BackgroundVideo {
 
+bool overlayVisible(const std::string& overlayColor) {
+    size_t atPos = overlayColor.find('@');
+    if (atPos == std::string::npos) return true;
+    try {
+        return std::stod(overlayColor.substr(atPos + 1)) > 0.0;
+    } catch (...) {
+        return true;
+    }
+}
+
+fs::path manifestPath(const AppConfig& config) {
+    if (config.videoSelection.useLocalDirectory) {
+        return fs::path(config.videoSelection.localVideoDirectory) / "metadata.json";
+    }
+    return CacheUtils::getCacheRoot() / "backgrounds" / (config.videoSelection.r2Bucket + "_metadata.json");
+}
+
+void refreshManifest(const AppConfig& config, R2::Client* r2Client) {
+    if (config.videoSelection.useLocalDirectory) return;
+    static std::mutex refreshedMutex;
+    static std::set<fs::path> refreshed;
+    fs::path path = manifestPath(config);
+    std::lock_guard<std::mutex> lock(refreshedMutex);
+    if (!refreshed.insert(path).second) return;
+
+    try {
+        std::unique_ptr<R2::Client> ownClient;
+        if (!r2Client) {
+            R2::R2Config r2Config{
+                config.videoSelection.r2Endpoint,
+                config.videoSelection.r2AccessKey,
+                config.videoSelection.r2SecretKey,
+                config.videoSelection.r2Bucket,
+                config.videoSelection.usePublicBucket
+            };
+            ownClient = std::make_unique<R2::Client>(r2Config);
+            r2Client = ownClient.get();
+        }
+        fs::create_directories(path.parent_path());
+        if (r2Client->objectExists("metadata.json")) {
+            r2Client->downloadVideo("metadata.json", path);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "  Warning: Could not refresh background manifest: " << e.what() << std::endl;
+    }
+}
+
 Manager::Manager(const AppConfig& config, const CLIOptions& options)
     : config_(config), options_(options) {
     auto timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
@@ -58,6 +108,100 @@ void Manager::cacheVideo(const std::string& remoteKey, const std::string& localP
     }
 }
 
+void Manager::loadManifest(R2::Client* r2Client) {
+    refreshManifest(config_, r2Client);
+    manifest_ = BackgroundManifest::Manifest::load(manifestPath(config_));
+}
+
+std::string Manager::pickRendition(const std::string& videoKey, VideoSegment& segment) const {
+    segment.matchesOutput = false;
+    segment.overlayBaked = false;
+    segment.gopFrames = 0;
+    const auto* entry = manifest_.findByOutput(videoKey);
+    if (!entry) return videoKey;
+    
+    std::optional<BackgroundManifest::Rendition> rendition;
+    if (overlayVisible(config_.overlayColor)) {
+        rendition = entry->findRendition(config_.width, config_.height, config_.fps, config_.overlayColor);
+        segment.overlayBaked = rendition.has_value();
+    }
+    if (!rendition) {
+        rendition = entry->findRendition(config_.width, config_.height, config_.fps);
+    }
+    if (!rendition) return videoKey;
+    segment.matchesOutput = true;
+    segment.gopFrames = rendition->params.gopFrames;
+    return rendition->output;
+}
+
+bool Manager::canStreamCopy(const std::vector<VideoSegment>& segments) const {
+    // Renditions are yuv420p; any other output format needs the decode path anyway
+    if (segments.empty() || config_.pixelFormat != "yuv420p") return false;
+    bool anyBaked = false;
+    bool allBaked = true;
+    for (const auto& segment : segments) {
+        if (!segment.matchesOutput || segment.gopFrames <= 0) return false;
+        if (segment.gopFrames != segments.front().gopFrames) return false;
+        anyBaked = anyBaked || segment.overlayBaked;
+        allBaked = allBaked && segment.overlayBaked;
+    }
+    // A mix of dimmed and undimmed clips still needs per-segment drawbox
+    return !overlayVisible(config_.overlayColor) || allBaked || !anyBaked;
+}
+
+std::string Manager::writeConcatList(std::vector<VideoSegment>& segments, double totalDurationSeconds) {
+    // Cuts snap to GOP boundaries: every clip then ends right before a keyframe, so
+    // no kept frame references a dropped one. Each cut is rounded against the planned
+    // cumulative end rather than its own length, so range boundaries move by at most
+    // half a GOP and the rounding does not add up along the timeline.
+    double gopSeconds = static_cast<double>(segments.front().gopFrames) / config_.fps;
+    std::vector<double> lengths;
+    double planned = 0.0;
+    double timeline = 0.0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const auto& segment = segments[i];
+        planned += segment.trimmedDuration;
+        double length = segment.duration;
+        if (i + 1 == segments.size()) {
+            // The last clip rounds up so the background never ends before the audio
+            double needed = totalDurationSeconds - timeline;
+            if (segment.duration < needed - 1e-6) return "";
+            length = std::min(segment.duration, std::max(1.0, std::ceil(needed / gopSeconds - 1e-6)) * gopSeconds);
+        } else if (segment.needsTrim) {
+            double gops = std::max(1.0, std::round((planned - timeline) / gopSeconds));
+            length = std::min(segment.duration, gops * gopSeconds);
+        }
+        lengths.push_back(length);
+        timeline += length;
+    }
+
+    fs::path listPath = tempDir_ / "background.ffconcat";
+    std::ofstream list(listPath);
+    if (!list.is_open()) {
+        throw std::runtime_error("Failed to create background concat list: " + listPath.string());
+    }
+    
+    list << "ffconcat version 1.0\n";
+    for (size_t i = 0; i < segments.size(); ++i) {
+        auto& segment = segments[i];
+        std::string escaped;
+        for (char c : fs::absolute(segment.path).generic_string()) {
+            if (c == '\'') escaped += "'\\''";
+            else escaped += c;
+        }
+        list << "file '" << escaped << "'\n";
+        
+        segment.needsTrim = lengths[i] < segment.duration;
+        segment.trimmedDuration = lengths[i];
+        if (segment.needsTrim) list << "outpoint " << lengths[i] << "\n";
+    }
+    tempFiles_.push_back(listPath);
+    
+    std::cout << "  Stream-copy background timeline: " << segments.size() << " clips, "
+              << timeline << "s (requested " << totalDurationSeconds << "s)" << std::endl;
+    return listPath.string();
+}
+
 std::vector<std::string> Manager::listLocalVideos(const std::string& theme) {
     std::vector<std::string> videos;
     fs::path themePath = fs::path(config_.videoSelection.localVideoDirectory) / theme;
@@ -72,6 +216,8 @@ std::vector<std::string> Manager::listLocalVideos(const std::string& theme) {
         std::string ext = entry.path().extension().string();
         std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
         
+        if (BackgroundManifest::isRenditionVariant(entry.path().stem().string())) continue;
+        
         if (ext == ".mp4" || ext == ".mov" || ext == ".avi" || 
             ext == ".mkv" || ext == ".webm") {
             // Return relative path from video directory
@@ -157,6 +303,7 @@ std::string Manager::buildFilterComplex(double totalDurationSeconds,
             };
             r2Client = std::make_unique<R2::Client>(r2Config);
         }
+        loadManifest(r2Client.get());
         
         // Build video cache for all themes
         std::map<std::string, std::vector<std::string>> themeVideosCache;
@@ -165,7 +312,11 @@ std::string Manager::buildFilterComplex(double totalDurationSeconds,
                 if (config_.videoSelection.useLocalDirectory) {
                     themeVideosCache[theme] = listLocalVideos(theme);
                 } else {
-                    themeVideosCache[theme] = r2Client->listVideosInTheme(theme);
+                    auto videos = r2Client->listVideosInTheme(theme);
+                    videos.erase(std::remove_if(videos.begin(), videos.end(), [](const std::string& key) {
+                        return BackgroundManifest::isRenditionVariant(fs::path(key).stem().string());
+                    }), videos.end());
+                    themeVideosCache[theme] = videos;
                 }
                 
                 if (themeVideosCache[theme].empty()) {
@@ -230,26 +381,32 @@ std::string Manager::buildFilterComplex(double totalDurationSeconds,
                       << " - theme: " << entry.theme 
                       << ", video: " << fs::path(entry.videoKey).filename().string();
             
+            VideoSegment segment;
+            std::string videoKey = pickRendition(entry.videoKey, segment);
+            if (videoKey != entry.videoKey) {
+                std::cout << " (rendition " << fs::path(videoKey).filename().string() << ")";
+            }
+            
             // Get the video (download from R2 or use local)
             std::string localPath;
             
             if (config_.videoSelection.useLocalDirectory) {
                 // Local directory - construct full path
-                localPath = (fs::path(config_.videoSelection.localVideoDirectory) / entry.videoKey).string();
+                localPath = (fs::path(config_.videoSelection.localVideoDirectory) / videoKey).string();
                 if (!fs::exists(localPath)) {
                     std::cerr << " (file not found)" << std::endl;
                     continue;
                 }
             } else {
                 // R2 - check cache first, then download
-                if (isVideoCached(entry.videoKey)) {
-                    localPath = getCachedVideoPath(entry.videoKey);
+                if (isVideoCached(videoKey)) {
+                    localPath = getCachedVideoPath(videoKey);
                     std::cout << " (cached)";
                 } else {
-                    fs::path tempPath = tempDir_ / fs::path(entry.videoKey).filename();
+                    fs::path tempPath = tempDir_ / fs::path(videoKey).filename();
                     try {
-                        localPath = r2Client->downloadVideo(entry.videoKey, tempPath);
-                        cacheVideo(entry.videoKey, localPath);
+                        localPath = r2Client->downloadVideo(videoKey, tempPath);
+                        cacheVideo(videoKey, localPath);
                         tempFiles_.push_back(tempPath);
                     } catch (const std::exception& e) {
                         std::cerr << " (download failed: " << e.what() << ")" << std::endl;
@@ -268,7 +425,6 @@ std::string Manager::buildFilterComplex(double totalDurationSeconds,
             std::cout << ", duration: " << duration << "s";
             
             // Build segment info
-            VideoSegment segment;
             segment.path = localPath;
             segment.theme = entry.theme;
             segment.duration = duration;
@@ -306,23 +462,71 @@ std::string Manager::buildFilterComplex(double totalDurationSeconds,
         std::cout << "  Collected " << segments.size() << " segments, total duration: " 
                   << currentTime << " seconds" << std::endl;
         
+        // Standardized GOP-aligned clips at the output format can be joined by the
+        // concat demuxer: one stream-copied input, one decoder, however many clips
+        if (canStreamCopy(segments)) {
+            std::string listPath = writeConcatList(segments, totalDurationSeconds);
+            if (!listPath.empty()) {
+                outputInputFiles.assign(1, listPath);
+                segments_ = segments;
+                usesConcatList_ = true;
+                overlayApplied_ = segments.front().overlayBaked;
+                return "[0:v]setpts=PTS-STARTPTS,setsar=1";
+            }
+            std::cout << "  Last clip cannot cover the timeline at a keyframe; decoding clips instead" << std::endl;
+        }
+        
+        segments_ = segments;
+        
         // Build concat filter
         std::ostringstream filter;
+        bool applyOverlay = overlayVisible(config_.overlayColor);
+        size_t bakedCount = std::count_if(segments.begin(), segments.end(),
+                                          [](const VideoSegment& s) { return s.overlayBaked; });
+        if (applyOverlay && bakedCount > 0) {
+            std::cout << "  Pre-dimmed renditions: " << bakedCount << "/" << segments.size() << std::endl;
+        }
         
         // First, scale and trim all inputs
         for (size_t i = 0; i < segments.size(); ++i) {
             filter << "[" << i << ":v]";
             
+            std::vector<std::string> steps;
+            
             // Trim if needed
             if (segments[i].needsTrim) {
-                filter << "trim=duration=" << segments[i].trimmedDuration << ",setpts=PTS-STARTPTS,";
+                std::ostringstream trim;
+                trim << "trim=duration=" << segments[i].trimmedDuration << ",setpts=PTS-STARTPTS";
+                steps.push_back(trim.str());
+            }
+            
+            // Scale to configured dimensions and normalize parameters, unless the
+            // standardizer already produced this exact size and frame rate
+            if (!segments[i].matchesOutput) {
+                std::ostringstream normalize;
+                normalize << "scale=" << config_.width << ":" << config_.height 
+                          << ",fps=" << config_.fps
+                          << ",format=" << config_.pixelFormat
+                          << ",setsar=1";
+                steps.push_back(normalize.str());
+            } else {
+                // Renditions are yuv420p; clips adopted from before the ladder may carry a
+                // non-square SAR, which concat would reject
+                if (config_.pixelFormat != "yuv420p") steps.push_back("format=" + config_.pixelFormat);
+                steps.push_back("setsar=1");
             }
             
-            // Scale to configured dimensions and normalize parameters
-            filter << "scale=" << config_.width << ":" << config_.height 
-                   << ",fps=" << config_.fps
-                   << ",format=" << config_.pixelFormat
-                   << ",setsar=1[v" << i << "]; ";
+            // Dim only the clips that were not standardized pre-dimmed
+            if (applyOverlay && !segments[i].overlayBaked) {
+                steps.push_back("drawbox=x=0:y=0:w=iw:h=ih:color=" + config_.overlayColor + ":t=fill");
+            }
+            
+            if (steps.empty()) steps.push_back("null");
+            for (size_t s = 0; s < steps.size(); ++s) {
+                if (s > 0) filter << ",";
+                filter << steps[s];
+            }
+            filter << "[v" << i << "]; ";
         }
         
         // Then concat them
@@ -332,6 +536,7 @@ std::string Manager::buildFilterComplex(double totalDurationSeconds,
         filter << "concat=n=" << segments.size() << ":v=1:a=0[bg]; ";
         filter << "[bg]setpts=PTS-STARTPTS";
         
+        overlayApplied_ = true;
         return filter.str();
         
     } catch (const std::exception& e) {
@@ -341,6 +546,20 @@ std::string Manager::buildFilterComplex(double totalDurationSeconds,
     }
 }
 
+std::optional<std::pair<VideoSegment, double>> Manager::locate(double seconds) const {
+    if (segments_.empty()) return std::nullopt;
+    double start = 0.0;
+    for (const auto& segment : segments_) {
+        if (seconds < start + segment.trimmedDuration) {
+            return std::make_pair(segment, std::max(0.0, seconds - start));
+        }
+        start += segment.trimmedDuration;
+    }
+    // Past the end the final frame of the last clip stays on screen
+    const auto& last = segments_.back();
+    return std::make_pair(last, std::max(0.0, last.trimmedDuration - 0.1));
+}
+
 void Manager::cleanup() {
     for (const auto& file : tempFiles_) {
         std::error_code ec;
@@ -1,12 +1,30 @@
 #pragma once
 #include "types.h"
 #include "video_selector.h"
+#include "background_manifest.h"
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <optional>
+#include <utility>
+
+namespace R2 { class Client; }
 
 namespace BackgroundVideo {
 
+// False when the overlay color's alpha is zero, i.e. the dim would be a no-op
+bool overlayVisible(const std::string& overlayColor);
+
+// The library's standardization manifest: metadata.json of a local library, or the
+// cached copy of an R2 bucket's (<cache root>/backgrounds/<bucket>_metadata.json)
+std::filesystem::path manifestPath(const AppConfig& config);
+
+// Downloads an R2 bucket's manifest into manifestPath(config), at most once per process
+// so the render fingerprint and the render see the same copy; keeps the cached copy
+// when the bucket is unreachable. Uses r2Client, or a client of its own when null.
+// Nothing to do for local libraries.
+void refreshManifest(const AppConfig& config, R2::Client* r2Client = nullptr);
+
 struct VideoSegment {
     std::string path;
     std::string theme;
@@ -14,6 +32,9 @@ struct VideoSegment {
     double trimmedDuration;
     bool isLocal;
     bool needsTrim;
+    bool matchesOutput = false;  // rendition already at output size/fps, no scaling needed
+    bool overlayBaked = false;   // rendition already carries config.overlayColor
+    int gopFrames = 0;           // fixed keyframe interval of the rendition (0 = unknown)
 };
 
 class Manager {
@@ -24,6 +45,18 @@ public:
     std::string buildFilterComplex(double totalDurationSeconds, 
                                    std::vector<std::string>& outputInputFiles);
     
+    // True once buildFilterComplex has applied config.overlayColor itself (baked into the
+    // chosen renditions or drawn per segment); the caller must not draw it again
+    bool overlayApplied() const { return overlayApplied_; }
+    
+    // True when the single background input is an ffconcat list (needs -f concat -safe 0)
+    bool usesConcatList() const { return usesConcatList_; }
+    
+    // Segment on screen at `seconds` into the timeline and the offset into its clip,
+    // so a single frame can be decoded without the clips before it. Only valid after
+    // buildFilterComplex has returned a non-empty chain.
+    std::optional<std::pair<VideoSegment, double>> locate(double seconds) const;
+    
     // Cleanup temporary files
     void cleanup();
 
@@ -34,6 +67,24 @@ private:
     std::filesystem::path cacheDir_;
     std::vector<std::filesystem::path> tempFiles_;
     VideoSelector::SelectionState selectionState_;
+    BackgroundManifest::Manifest manifest_;
+    bool overlayApplied_ = false;
+    bool usesConcatList_ = false;
+    std::vector<VideoSegment> segments_;  // timeline of the last buildFilterComplex
+    
+    // Load the standardization manifest (metadata.json) from the library root
+    void loadManifest(R2::Client* r2Client);
+    
+    // Swap a listed clip for the rendition matching the output size and frame rate
+    // (pre-dimmed with config.overlayColor when such a rendition exists). Fills the
+    // segment's matchesOutput/overlayBaked/gopFrames and returns the key to load.
+    std::string pickRendition(const std::string& videoKey, VideoSegment& segment) const;
+    
+    // Stream-copy timeline: every segment is a GOP-aligned rendition at output format
+    bool canStreamCopy(const std::vector<VideoSegment>& segments) const;
+    // Writes the ffconcat list and updates the segments' trims to the GOP-aligned cuts;
+    // returns "" (and writes nothing) when the clips cannot cover totalDurationSeconds
+    std::string writeConcatList(std::vector<VideoSegment>& segments, double totalDurationSeconds);
     
     // Get video duration using libav
     double getVideoDuration(const std::string& path);
@@ -2,6 +2,8 @@
 #include "quran_data.h"
 #include <fstream>
 #include <unordered_map>
+#include <vector>
+#include <cstdint>
 #include <mutex>
 #include <cctype>
 #include <stdexcept>
@@ -66,6 +68,27 @@ namespace {
     std::mutex reciterCacheMutex;
     std::unordered_map<int, json> reciterAudioCache;
 
+    constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+    constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+    uint64_t fnv1a(uint64_t hash, const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= kFnvPrime;
+        }
+        return hash;
+    }
+
+    std::string toHex(uint64_t value) {
+        static const char* digits = "0123456789abcdef";
+        std::string out(16, '0');
+        for (int i = 15; i >= 0; --i) {
+            out[i] = digits[value & 0xF];
+            value >>= 4;
+        }
+        return out;
+    }
+
     void ensure_parent(const fs::path& path) {
         const auto parent = path.parent_path();
         if (!parent.empty()) {
@@ -181,6 +204,24 @@ std::string CacheUtils::sanitizeLabel(std::string value) {
     return value;
 }
 
+std::string CacheUtils::hashFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for hashing: " + path.string());
+    }
+    std::vector<char> buffer(1 << 20);
+    uint64_t hash = kFnvOffsetBasis;
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash = fnv1a(hash, buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+    return toHex(hash);
+}
+
+std::string CacheUtils::hashString(const std::string& value) {
+    return toHex(fnv1a(kFnvOffsetBasis, value.data(), value.size()));
+}
+
 bool CacheUtils::downloadFileWithRetry(const std::string& url, const fs::path& destination, int maxRetries) {
     ensure_parent(destination);
     for (int attempt = 1; attempt <= maxRetries; ++attempt) {
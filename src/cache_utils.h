@@ -20,5 +20,8 @@ namespace CacheUtils {
     std::filesystem::path buildCachedAudioPath(const std::string& label);
     bool fileIsValid(const std::filesystem::path& path);
     std::string sanitizeLabel(std::string value);
+    // Fast non-cryptographic content hashes (FNV-1a 64, hex) for change detection
+    std::string hashFile(const std::filesystem::path& path);
+    std::string hashString(const std::string& value);
     bool downloadFileWithRetry(const std::string& url, const std::filesystem::path& destination, int maxRetries = 4);
 }
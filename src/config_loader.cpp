@@ -79,13 +79,17 @@ struct QualityProfileSettings {
     std::string videoBitrate;
     std::string videoMaxRate;
     std::string videoBufSize;
+    std::string encoder;  // --encoder value; empty keeps the CLI's
 };
 
+// CRF scales differ per encoder: x265 defaults to 28 and SVT-AV1 to 35, against x264's 23
 std::map<std::string, QualityProfileSettings> defaultQualityProfiles() {
     return {
-        {"speed",    {"ultrafast", 25, "yuv420p",    "",       "",        ""}},
-        {"balanced", {"fast",      21, "yuv420p",    "4500k",  "",        ""}},
-        {"max",      {"slow",      18, "yuv420p10le","8000k",  "10000k",  "12000k"}}
+        {"speed",    {"ultrafast", 25, "yuv420p",    "",       "",        "",        ""}},
+        {"balanced", {"fast",      21, "yuv420p",    "4500k",  "",        "",        ""}},
+        {"max",      {"slow",      18, "yuv420p10le","8000k",  "10000k",  "12000k",  ""}},
+        {"hevc",     {"medium",    26, "yuv420p",    "",       "",        "",        "x265"}},
+        {"av1",      {"fast",      35, "yuv420p",    "",       "",        "",        "svt-av1"}}
     };
 }
 
@@ -113,6 +117,7 @@ std::map<std::string, QualityProfileSettings> loadQualityProfiles(const json& da
         if (value.contains("videoBitrate")) settings.videoBitrate = value["videoBitrate"].get<std::string>();
         if (value.contains("videoMaxRate")) settings.videoMaxRate = value["videoMaxRate"].get<std::string>();
         if (value.contains("videoBufSize")) settings.videoBufSize = value["videoBufSize"].get<std::string>();
+        if (value.contains("encoder")) settings.encoder = value["encoder"].get<std::string>();
         profiles[normalized] = settings;
     }
     return profiles;
@@ -133,6 +138,9 @@ void applyQualityProfile(AppConfig& cfg,
     if (!options.presetProvided && !defaults.preset.empty()) {
         options.preset = defaults.preset;
     }
+    if (!options.encoderProvided && !defaults.encoder.empty()) {
+        options.encoder = defaults.encoder;
+    }
     if (cfg.crf <= 0 && defaults.crf > 0) {
         cfg.crf = defaults.crf;
     }
@@ -336,6 +344,8 @@ AppConfig loadConfig(const std::string& path, CLIOptions& options) {
     cfg.videoBitrate = data.value("videoBitrate", "");
     cfg.videoMaxRate = data.value("videoMaxRate", "");
     cfg.videoBufSize = data.value("videoBufSize", "");
+    cfg.threads = data.value("threads", 0);
+    cfg.jobs = data.value("jobs", 1);
     auto qualityProfiles = loadQualityProfiles(data);
 
     // Video selection configuration
@@ -421,6 +431,8 @@ AppConfig loadConfig(const std::string& path, CLIOptions& options) {
     if (!options.videoBitrateOverride.empty()) cfg.videoBitrate = options.videoBitrateOverride;
     if (!options.videoMaxRateOverride.empty()) cfg.videoMaxRate = options.videoMaxRateOverride;
     if (!options.videoBufSizeOverride.empty()) cfg.videoBufSize = options.videoBufSizeOverride;
+    if (options.threadsOverride != -1) cfg.threads = options.threadsOverride;
+    if (options.jobsOverride != -1) cfg.jobs = options.jobsOverride;
 
     if (cfg.crf <= 0) cfg.crf = 23;
     if (cfg.pixelFormat.empty()) cfg.pixelFormat = "yuv420p";
@@ -444,3 +456,17 @@ void validateAssets(const AppConfig& config) {
         throw std::runtime_error("Quran word-by-word data not found: " + config.quranWordByWordPath);
     }
 }
+
+AppConfig withTranslation(const AppConfig& config, const CLIOptions& options, int translationId) {
+    // Reload so config-file font overrides are honoured exactly as for a --translation run
+    CLIOptions translated = options;
+    translated.translationId = translationId;
+    AppConfig loaded = loadConfig(options.configPath, translated);
+
+    AppConfig result = config;
+    result.translationId = loaded.translationId;
+    result.translationIsRtl = loaded.translationIsRtl;
+    result.translationFont.family = loaded.translationFont.family;
+    result.translationFont.file = loaded.translationFont.file;
+    return result;
+}
@@ -5,3 +5,6 @@
 
 AppConfig loadConfig(const std::string& path, CLIOptions& options);
 void validateAssets(const AppConfig& config);
+
+// Copy of config with the translation, its direction and its default font switched to translationId
+AppConfig withTranslation(const AppConfig& config, const CLIOptions& options, int translationId);
@@ -0,0 +1,180 @@
+#include "deadline_planner.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace DeadlinePlanner {
+
+namespace {
+
+// Long enough for x264's lookahead to fill and the encoder to reach steady state
+constexpr double kCalibrationSeconds = 2.0;
+
+double median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+double jobPixels(const Job& job) {
+    return static_cast<double>(job.width) * job.height * job.fps * job.seconds;
+}
+
+} // namespace
+
+const std::vector<std::string>& presets() {
+    static const std::vector<std::string> names = {
+        "ultrafast", "superfast", "veryfast", "faster", "fast", "medium", "slow", "slower", "veryslow"
+    };
+    return names;
+}
+
+double pixelRate(const std::vector<RenderHistory::Entry>& history,
+                 const std::string& preset,
+                 const std::string& source) {
+    std::vector<double> rates;
+    for (const auto& entry : history) {
+        double rate = entry.pixelRate();
+        if (entry.preset == preset && entry.source == source && rate > 0.0) rates.push_back(rate);
+    }
+    return median(rates);
+}
+
+Decision choose(const Job& job,
+                double deadlineSeconds,
+                const std::vector<RenderHistory::Entry>& history,
+                const Calibrate& calibrate) {
+    const auto& names = presets();
+    auto renders = [&](const std::string& preset) {
+        return std::count_if(history.begin(), history.end(), [&](const RenderHistory::Entry& entry) {
+            return entry.source == "render" && entry.preset == preset && entry.pixelRate() > 0.0;
+        });
+    };
+
+    // Calibration rates of this run, fresh or from the history
+    std::map<std::string, double> calibrations;
+    auto calibrationRate = [&](const std::string& preset, bool& fresh) {
+        fresh = false;
+        auto found = calibrations.find(preset);
+        if (found != calibrations.end()) return found->second;
+        double rate = pixelRate(history, preset, "calibration");
+        if (rate <= 0.0 && calibrate) {
+            rate = calibrate(preset);
+            fresh = true;
+        }
+        calibrations[preset] = rate;
+        return rate;
+    };
+
+    // Full renders include decode, filters and muxing; calibrations only the encoder. Once
+    // any preset has renders, calibrations are scaled by that preset's render/calibration
+    // ratio so every candidate is compared on the render basis.
+    std::optional<double> scale;
+    std::string scaleBasis;
+    auto renderScale = [&]() -> std::optional<double> {
+        if (scale) return scale;
+        // A rendered preset, preferably one the history has calibrated already
+        std::string reference;
+        for (const auto& name : names) {
+            if (renders(name) == 0) continue;
+            if (pixelRate(history, name, "calibration") > 0.0) {
+                reference = name;
+                break;
+            }
+            if (reference.empty() || renders(name) > renders(reference)) reference = name;
+        }
+        if (reference.empty()) {
+            scale = 1.0;
+            return scale;
+        }
+        bool fresh = false;
+        double calibrated = calibrationRate(reference, fresh);
+        if (calibrated <= 0.0) return std::nullopt;
+        scale = pixelRate(history, reference, "render") / calibrated;
+        scaleBasis = ", scaled by renders of '" + reference + "'";
+        return scale;
+    };
+
+    std::map<size_t, Decision> estimates;
+    auto estimate = [&](size_t index) -> std::optional<Decision> {
+        auto found = estimates.find(index);
+        if (found != estimates.end()) return found->second;
+        Decision decision;
+        decision.preset = names[index];
+        double rate = pixelRate(history, decision.preset, "render");
+        size_t runs = renders(decision.preset);
+        decision.basis = "history, " + std::to_string(runs) + " encode" + (runs == 1 ? "" : "s");
+        if (rate <= 0.0) {
+            auto factor = renderScale();
+            if (!factor) return std::nullopt;
+            bool fresh = false;
+            rate = calibrationRate(decision.preset, fresh) * *factor;
+            decision.basis = (fresh ? "calibration encode" : "history calibration") + scaleBasis;
+        }
+        if (rate <= 0.0) return std::nullopt;
+        decision.estimatedSeconds = jobPixels(job) / rate;
+        decision.fits = decision.estimatedSeconds <= deadlineSeconds;
+        estimates[index] = decision;
+        return decision;
+    };
+
+    auto fastest = estimate(0);
+    if (!fastest) return {};
+    if (!fastest->fits) return *fastest;
+
+    // Largest index that still fits, with index 0 known to fit
+    size_t low = 0, high = names.size() - 1;
+    while (low < high) {
+        size_t middle = (low + high + 1) / 2;
+        auto candidate = estimate(middle);
+        if (!candidate) return {};
+        if (candidate->fits) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return estimates[low];
+}
+
+double calibrate(const std::string& preset,
+                 const Job& job,
+                 const std::string& pixelFormat,
+                 const ThreadPolicy::Allocation& threads,
+                 std::shared_ptr<Interfaces::IProcessExecutor> processExecutor,
+                 const fs::path& historyPath) {
+    std::ostringstream cmd;
+    cmd << "ffmpeg -y -v error -f lavfi -i testsrc2=s=" << job.width << "x" << job.height
+        << ":r=" << job.fps << ":d=" << kCalibrationSeconds << " "
+        << "-c:v libx264 -preset " << preset << " -pix_fmt " << pixelFormat << " "
+        << ThreadPolicy::encoderArgs(threads, 1, true) << "-f null -";
+    std::cout << "Calibrating preset '" << preset << "'..." << std::endl;
+
+    auto started = std::chrono::steady_clock::now();
+    int exit_code = processExecutor->execute(cmd.str());
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    if (exit_code != 0) {
+        std::cerr << "Warning: Calibration encode for preset '" << preset << "' failed" << std::endl;
+        return 0.0;
+    }
+
+    RenderHistory::Entry entry;
+    entry.source = "calibration";
+    entry.preset = preset;
+    entry.width = job.width;
+    entry.height = job.height;
+    entry.fps = job.fps;
+    entry.videoSeconds = kCalibrationSeconds;
+    // Process start-up alone takes longer than this; it only guards against a zero time
+    entry.wallSeconds = std::max(elapsed.count(), 1e-3);
+    RenderHistory::append(historyPath, entry);
+    return entry.pixelRate();
+}
+
+} // namespace DeadlinePlanner
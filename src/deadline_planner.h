@@ -0,0 +1,60 @@
+#pragma once
+#include "render_history.h"
+#include "thread_policy.h"
+#include "interfaces/IProcessExecutor.h"
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// --deadline: the slowest x264 preset whose predicted encode time fits the deadline.
+// Predictions come from earlier encodes in the render history, or from a short
+// calibration encode for presets the history has not seen. Calibrations time the
+// encoder alone, so once any renders exist they are scaled onto the render basis.
+namespace DeadlinePlanner {
+
+// x264 presets, fastest first
+const std::vector<std::string>& presets();
+
+// The encode to plan for
+struct Job {
+    int width = 0;
+    int height = 0;
+    int fps = 0;
+    double seconds = 0.0;
+};
+
+struct Decision {
+    std::string preset;              // empty when no preset could be estimated
+    double estimatedSeconds = 0.0;
+    std::string basis;               // where the estimate came from, for the log
+    bool fits = false;               // false: even the fastest preset misses the deadline
+};
+
+// Median pixel rate of the history's entries from `source` ("render" or "calibration")
+// with this preset; 0 when there are none
+double pixelRate(const std::vector<RenderHistory::Entry>& history,
+                 const std::string& preset,
+                 const std::string& source);
+
+// Measures a preset's pixel rate; returns 0 on failure
+using Calibrate = std::function<double(const std::string& preset)>;
+
+// Presets are assumed to get slower monotonically, so only about log2(9) of them are
+// estimated (and at most that many calibrated, plus one rendered preset to scale by)
+Decision choose(const Job& job,
+                double deadlineSeconds,
+                const std::vector<RenderHistory::Entry>& history,
+                const Calibrate& calibrate);
+
+// Encodes a few seconds of synthetic video at the job's size with `preset`, appends the
+// result to the history at historyPath and returns its pixel rate (0 on failure)
+double calibrate(const std::string& preset,
+                 const Job& job,
+                 const std::string& pixelFormat,
+                 const ThreadPolicy::Allocation& threads,
+                 std::shared_ptr<Interfaces::IProcessExecutor> processExecutor,
+                 const std::filesystem::path& historyPath);
+
+} // namespace DeadlinePlanner
@@ -0,0 +1,140 @@
+#include "encoder_backends.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace EncoderBackends {
+
+namespace {
+
+// VBV caps only: with -b:v, libx265 and libsvtav1 switch from CRF to average bitrate
+void cappedRate(std::ostringstream& args, const RateControl& rate) {
+    if (!rate.maxRate.empty()) args << "-maxrate " << rate.maxRate << " ";
+    if (!rate.bufSize.empty()) args << "-bufsize " << rate.bufSize << " ";
+}
+
+} // namespace
+
+const std::vector<std::string>& names() {
+    static const std::vector<std::string> encoders = {"software", "x265", "svt-av1", "hardware"};
+    return encoders;
+}
+
+bool isKnown(const std::string& encoder) {
+    return std::find(names().begin(), names().end(), encoder) != names().end();
+}
+
+std::string codecName(const std::string& encoder) {
+    if (encoder == "x265") return "libx265";
+    if (encoder == "svt-av1") return "libsvtav1";
+#if defined(__APPLE__)
+    if (encoder == "hardware") return "h264_videotoolbox";
+#endif
+    return "libx264";
+}
+
+std::string svtPreset(const std::string& preset) {
+    static const std::map<std::string, std::string> presets = {
+        {"ultrafast", "12"}, {"superfast", "11"}, {"veryfast", "10"}, {"faster", "9"}, {"fast", "8"},
+        {"medium", "6"}, {"slow", "5"}, {"slower", "4"}, {"veryslow", "2"}
+    };
+    auto found = presets.find(preset);
+    return found != presets.end() ? found->second : preset;
+}
+
+std::string videoArgs(const std::string& encoder,
+                      const std::string& preset,
+                      const RateControl& rate,
+                      const ThreadPolicy::Allocation& threads,
+                      int encoders) {
+    std::string codec = codecName(encoder);
+    int encoderThreads = ThreadPolicy::threadsPerEncoder(threads, encoders);
+    std::ostringstream args;
+    args << "-c:v " << codec << " ";
+    if (codec == "h264_videotoolbox") {
+        args << "-b:v " << (!rate.bitrate.empty() ? rate.bitrate : "3500k") << " ";
+        cappedRate(args, rate);
+        args << "-allow_sw 1 " << ThreadPolicy::encoderArgs(threads, encoders, false);
+    } else if (codec == "libx265") {
+        // aq-mode=3 favours the dark, flat areas of dimmed backgrounds; SAO smooths the
+        // sharp glyph edges that make up most of the detail in these videos
+        args << "-preset " << preset << " -crf " << rate.crf << " ";
+        cappedRate(args, rate);
+        args << "-x265-params pools=" << encoderThreads << ":aq-mode=3:no-sao=1 ";
+    } else if (codec == "libsvtav1") {
+        // tune=0 optimizes for visual quality rather than PSNR
+        args << "-preset " << svtPreset(preset) << " -crf " << rate.crf << " ";
+        cappedRate(args, rate);
+        args << "-svtav1-params lp=" << encoderThreads << ":tune=0 ";
+    } else {
+        args << "-preset " << preset << " -crf " << rate.crf << " ";
+        if (!rate.bitrate.empty()) args << "-b:v " << rate.bitrate << " ";
+        cappedRate(args, rate);
+        args << ThreadPolicy::encoderArgs(threads, encoders, true);
+    }
+    return args.str();
+}
+
+json BenchmarkResult::toJson() const {
+    return {
+        {"profile", profile},
+        {"encoder", encoder},
+        {"preset", preset},
+        {"crf", crf},
+        {"ok", ok},
+        {"wallSeconds", wallSeconds},
+        {"speed", speed},
+        {"bytes", bytes},
+        {"kbps", kbps}
+    };
+}
+
+BenchmarkResult benchmark(const std::string& video,
+                          double seconds,
+                          const std::string& encoder,
+                          const std::string& preset,
+                          const RateControl& rate,
+                          const std::string& pixelFormat,
+                          const ThreadPolicy::Allocation& threads,
+                          std::shared_ptr<Interfaces::IProcessExecutor> processExecutor) {
+    BenchmarkResult result;
+    result.encoder = encoder;
+    result.preset = preset;
+    result.crf = rate.crf;
+
+    fs::path output = fs::temp_directory_path() / ("qvm_benchmark_" + encoder + ".mp4");
+    std::error_code ec;
+    fs::remove(output, ec);
+    std::ostringstream cmd;
+    cmd << "ffmpeg -y -v error -i \"" << video << "\" -map 0:v:0 -an "
+        << videoArgs(encoder, preset, rate, threads, 1)
+        << (encoder == "x265" ? "-tag:v hvc1 " : "") << "-pix_fmt " << pixelFormat << " \""
+        << output.string() << "\"";
+    std::cout << "\nBenchmarking " << codecName(encoder) << " ('" << preset << "', crf " << rate.crf << "):\n"
+              << cmd.str() << std::endl;
+
+    auto started = std::chrono::steady_clock::now();
+    int exit_code = processExecutor->execute(cmd.str());
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    result.wallSeconds = elapsed.count();
+    if (exit_code != 0 || !fs::exists(output, ec)) {
+        std::cerr << "Warning: " << codecName(encoder) << " benchmark failed (is the encoder built into ffmpeg?)"
+                  << std::endl;
+        return result;
+    }
+    result.ok = true;
+    result.bytes = static_cast<long long>(fs::file_size(output, ec));
+    if (result.wallSeconds > 0.0) result.speed = seconds / result.wallSeconds;
+    if (seconds > 0.0) result.kbps = result.bytes * 8.0 / 1000.0 / seconds;
+    fs::remove(output, ec);
+    return result;
+}
+
+} // namespace EncoderBackends
@@ -0,0 +1,66 @@
+#pragma once
+#include "thread_policy.h"
+#include "interfaces/IProcessExecutor.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Video encoders selectable with --encoder or a quality profile's "encoder":
+//   software  libx264
+//   x265      libx265 (HEVC)
+//   svt-av1   libsvtav1 (AV1)
+//   hardware  h264_videotoolbox on macOS, libx264 elsewhere
+namespace EncoderBackends {
+
+const std::vector<std::string>& names();
+bool isKnown(const std::string& encoder);
+
+// FFmpeg encoder name for an --encoder value
+std::string codecName(const std::string& encoder);
+
+// SVT-AV1 presets are numbers (0 slowest .. 13 fastest); x264 preset names map onto them
+std::string svtPreset(const std::string& preset);
+
+struct RateControl {
+    int crf = 23;                 // in the encoder's own scale (x265 and AV1 differ from x264)
+    std::string bitrate;
+    std::string maxRate;
+    std::string bufSize;
+};
+
+// "-c:v ..." with preset, rate control, threads and the content tuning of the encoder,
+// for one of `encoders` encoders running in the same ffmpeg process
+std::string videoArgs(const std::string& encoder,
+                      const std::string& preset,
+                      const RateControl& rate,
+                      const ThreadPolicy::Allocation& threads,
+                      int encoders);
+
+// Throughput and size of one profile re-encoding a sample video
+struct BenchmarkResult {
+    std::string profile;
+    std::string encoder;
+    std::string preset;
+    int crf = 0;
+    bool ok = false;
+    double wallSeconds = 0.0;
+    double speed = 0.0;           // seconds of video encoded per wall second
+    long long bytes = 0;
+    double kbps = 0.0;
+
+    nlohmann::json toJson() const;
+};
+
+// Encodes `video` (video only) with the given settings into a temporary file and
+// measures it; `seconds` is the sample's length
+BenchmarkResult benchmark(const std::string& video,
+                          double seconds,
+                          const std::string& encoder,
+                          const std::string& preset,
+                          const RateControl& rate,
+                          const std::string& pixelFormat,
+                          const ThreadPolicy::Allocation& threads,
+                          std::shared_ptr<Interfaces::IProcessExecutor> processExecutor);
+
+} // namespace EncoderBackends
@@ -1,11 +1,20 @@
 #pragma once
+#include <functional>
 #include <string>
 
 namespace Interfaces {
+    // Pull-style reader over a running command's stdout; returns 0 at end of output.
+    // At end of output it waits for the command and throws if it exited non-zero, so a
+    // consumer never mistakes a crashed command's truncated output for a complete one.
+    using OutputReader = std::function<size_t(char* buffer, size_t size)>;
+
     class IProcessExecutor {
     public:
         virtual ~IProcessExecutor() = default;
         virtual int execute(const std::string& command) = 0;
         virtual void executeWithProgress(const std::string& command, double totalDurationSeconds) = 0;
+        // Runs command, hands its stdout to consume() and returns the exit code once it exits
+        virtual int executeStreaming(const std::string& command,
+                                     const std::function<void(const OutputReader&)>& consume) = 0;
     };
 }
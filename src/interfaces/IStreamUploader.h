@@ -0,0 +1,13 @@
+#pragma once
+#include "interfaces/IProcessExecutor.h"
+#include <string>
+
+namespace Interfaces {
+    class IStreamUploader {
+    public:
+        virtual ~IStreamUploader() = default;
+        // Uploads everything the reader yields to key; false when the upload did not complete.
+        // If the reader throws, nothing may be published under key.
+        virtual bool upload(const OutputReader& reader, const std::string& key) = 0;
+    };
+}
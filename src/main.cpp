@@ -2,6 +2,8 @@
 #include <stdexcept>
 #include <filesystem>
 #include <vector>
+#include <sstream>
+#include <algorithm>
 #include "cxxopts.hpp"
 #include "video_standardizer.h"
 #include "types.h"
@@ -10,8 +12,18 @@
 #include "quran_data.h"
 #include "config_loader.h"
 #include "SystemProcessExecutor.h"
+#include "R2StreamUploader.h"
 #include <memory>
 #include "metadata_writer.h"
+#include "render_cache.h"
+#include "background_video_manager.h"
+#include "render_history.h"
+#include "deadline_planner.h"
+#include "encoder_backends.h"
+#include "thread_policy.h"
+#include "audio/custom_audio_processor.h"
+#include <iomanip>
+#include "verse_index.h"
 #include "cache_utils.h"
 #include "verse_segmentation.h"
 #include "localization_utils.h"
@@ -43,7 +55,7 @@ int main(int argc, char* argv[]) {
         ("translation-font-size", "Override translation font size", cxxopts::value<int>())
         ("translation-font-color", "Override translation font color (hex format, e.g., FFFFFF)", cxxopts::value<std::string>())
         ("text-padding", "Horizontal padding fraction (0-0.45) for subtitles", cxxopts::value<double>())
-        ("e,encoder", "Choose encoder: 'software' (default) or 'hardware'", cxxopts::value<std::string>()->default_value("software"))
+        ("e,encoder", "Choose encoder: 'software' (libx264, default), 'x265', 'svt-av1' or 'hardware'", cxxopts::value<std::string>()->default_value("software"))
         ("p,preset", "Software encoder preset for speed/quality (ultrafast, fast, medium)", cxxopts::value<std::string>()->default_value("fast"))
         ("quality-profile", "Quality profile: speed | balanced | max", cxxopts::value<std::string>())
         ("crf", "Constant Rate Factor (0-51). Lower improves quality.", cxxopts::value<int>())
@@ -51,8 +63,26 @@ int main(int argc, char* argv[]) {
         ("video-bitrate", "Target video bitrate (e.g. 6000k)", cxxopts::value<std::string>())
         ("maxrate", "Maximum encoder bitrate (e.g. 8000k)", cxxopts::value<std::string>())
         ("bufsize", "Encoder buffer size (e.g. 12000k)", cxxopts::value<std::string>())
+        ("threads", "Threads for rendering on this host (default: usable cores, honouring cgroup CPU quota)", cxxopts::value<int>())
+        ("jobs", "Renders running side by side on this host; each gets threads / jobs", cxxopts::value<int>())
         ("no-cache", "Disable caching", cxxopts::value<bool>()->default_value("false"))
         ("clear-cache", "Clear all cached data", cxxopts::value<bool>()->default_value("false"))
+        ("render-store", "Directory of finished renders keyed by input fingerprint (default: cache/renders)", cxxopts::value<std::string>())
+        ("renditions", "Extra outputs encoded from the same decode (e.g. 1280x720,1080x1920,854x480:30)", cxxopts::value<std::string>())
+        ("translations", "Extra outputs with other translations from the same decode (e.g. 20,85,131)", cxxopts::value<std::string>())
+        ("extract", "Cut verses --from..--to out of an existing render by stream copy (needs its .verses.json)", cxxopts::value<std::string>())
+        ("container", "Output container: mp4 (faststart), fmp4 (fragmented, written progressively) or hls", cxxopts::value<std::string>()->default_value("mp4"))
+        ("loop-memory-mb", "Memory budget for replaying the decoded background loop (0 = re-decode with -stream_loop)", cxxopts::value<int>())
+        ("prerender-text", "Rasterize subtitle text once (fades and growth in steps) and overlay it instead of rendering every frame")
+        ("static-bg", "Treat the background video as a still image: encode frames only when subtitles change (VFR output)")
+        ("still", "Write one PNG of the render at <seconds> or a verse key (e.g. 2:255) instead of the video", cxxopts::value<std::string>())
+        ("deadline", "Seconds the encode may take; picks the slowest x264 preset predicted to finish in time", cxxopts::value<double>())
+        ("estimate", "Predict wall time, CPU time and peak memory of the render from earlier runs and exit (ESTIMATE {...})")
+        ("benchmark-encoders", "Re-encode this video with the balanced, hevc and av1 quality profiles and report speed and size", cxxopts::value<std::string>())
+        ("draft", "Fast low-resolution preview (360p, 15 fps, ultrafast); skips the thumbnail and metadata")
+        ("upload-r2", "Stream the finished video into this R2 object key while it encodes (no local file)", cxxopts::value<std::string>())
+        ("upload-bucket", "Bucket for --upload-r2 (default: --r2-bucket)", cxxopts::value<std::string>())
+        ("soft-subtitles", "Burn only the Arabic text; carry translations as subtitle tracks (mov_text, or ASS with a .mkv output)")
         ("no-growth", "Disable text growth animations", cxxopts::value<bool>()->default_value("false"))
         ("progress", "Emit structured progress logs (PROGRESS ...)", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
         ("bg-theme", "Background video theme (space, nature, abstract, minimal)", cxxopts::value<std::string>())
@@ -68,6 +98,14 @@ int main(int argc, char* argv[]) {
         ("r2-bucket", "R2 bucket name", cxxopts::value<std::string>()->default_value("quran-background-videos"))
         ("standardize-local", "Standardize all videos in a local directory", cxxopts::value<std::string>())
         ("standardize-r2", "Standardize videos in R2 bucket (requires credentials)", cxxopts::value<std::string>())
+        ("standardize-jobs", "Number of clips standardized concurrently (default: cores / 4)", cxxopts::value<int>())
+        ("standardize-threads", "FFmpeg threads per standardization job (default: cores / jobs)", cxxopts::value<int>())
+        ("standardize-crf", "CRF for standardized clips; changing it re-standardizes existing clips", cxxopts::value<int>())
+        ("standardize-keep-source", "Keep original clips after standardizing so later runs can re-encode them")
+        ("standardize-stream", "Stream R2 clips through ffmpeg into multipart uploads without temp files")
+        ("standardize-gop", "Keyframe interval in seconds for standardized clips (0 = encoder default)", cxxopts::value<int>())
+        ("standardize-overlays", "Overlay colors to bake into pre-dimmed renditions (e.g. 0x000000@0.5)", cxxopts::value<std::string>())
+        ("standardize-ladder", "Renditions to produce per clip, primary first (e.g. 1280x720,1920x1080,1080x1920@30)", cxxopts::value<std::string>())
         ("segment-long-verses", "Enable segmentation of long verses into timed parts", cxxopts::value<bool>()->default_value("false"))
         ("segment-data", "Path to reciter-specific segment timing JSON file", cxxopts::value<std::string>())
         ("long-verses", "Path to list of long verses (default: metadata/long-verses.json)", cxxopts::value<std::string>()->default_value("metadata/long-verses.json"))
@@ -81,9 +119,33 @@ int main(int argc, char* argv[]) {
     auto result = cli_parser.parse(argc, argv);
 
     // Handle standardization
+    VideoStandardizer::Options standardizeOptions;
+    if (result.count("standardize-jobs")) standardizeOptions.jobs = result["standardize-jobs"].as<int>();
+    if (result.count("standardize-threads")) standardizeOptions.threadsPerJob = result["standardize-threads"].as<int>();
+    if (result.count("standardize-crf")) standardizeOptions.crf = result["standardize-crf"].as<int>();
+    if (result.count("standardize-keep-source")) standardizeOptions.keepSources = true;
+    if (result.count("standardize-gop")) standardizeOptions.gopSeconds = result["standardize-gop"].as<int>();
+    if (result.count("standardize-stream")) standardizeOptions.stream = true;
+    if (result.count("standardize-overlays")) {
+        std::stringstream overlays(result["standardize-overlays"].as<std::string>());
+        std::string overlay;
+        while (std::getline(overlays, overlay, ',')) {
+            if (!overlay.empty()) standardizeOptions.overlays.push_back(overlay);
+        }
+    }
+    if (result.count("standardize-ladder")) {
+        try {
+            standardizeOptions.ladder = BackgroundManifest::parseLadder(
+                result["standardize-ladder"].as<std::string>(), standardizeOptions.fps, standardizeOptions.crf);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     if (result.count("standardize-local")) {
         try {
-            VideoStandardizer::standardizeDirectory(result["standardize-local"].as<std::string>(), false);
+            VideoStandardizer::standardizeDirectory(result["standardize-local"].as<std::string>(), standardizeOptions);
         } catch (const std::exception& e) {
             std::cerr << "Standardization failed: " << e.what() << std::endl;
             return 1;
@@ -93,7 +155,7 @@ int main(int argc, char* argv[]) {
 
     if (result.count("standardize-r2")) {
         try {
-            VideoStandardizer::standardizeDirectory(result["standardize-r2"].as<std::string>(), true);
+            VideoStandardizer::standardizeR2Bucket(result["standardize-r2"].as<std::string>(), standardizeOptions);
         } catch (const std::exception& e) {
             std::cerr << "Standardization failed: " << e.what() << std::endl;
             return 1;
@@ -120,6 +182,65 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (result.count("extract")) {
+        if (!result.count("from") || !result.count("to")) {
+            std::cerr << "Error: --extract requires --from and --to" << std::endl;
+            return 1;
+        }
+        try {
+            fs::path output = result.count("output") ? fs::path(result["output"].as<std::string>()) : fs::path();
+            VerseIndex::extract(result["extract"].as<std::string>(), result["from"].as<int>(), result["to"].as<int>(),
+                                output, std::make_shared<SystemProcessExecutor>());
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Extraction failed: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (result.count("benchmark-encoders")) {
+        try {
+            std::string sample = result["benchmark-encoders"].as<std::string>();
+            double seconds = Audio::CustomAudioProcessor::probeDuration(sample);
+            if (seconds <= 0.0) throw std::runtime_error("Could not read the duration of " + sample);
+            std::vector<EncoderBackends::BenchmarkResult> results;
+            for (const char* profile : {"balanced", "hevc", "av1"}) {
+                // Each profile as a render would use it: its encoder, preset, CRF and caps
+                CLIOptions benchOptions;
+                benchOptions.configPath = result["config"].as<std::string>();
+                benchOptions.configPathProvided = result.count("config") > 0;
+                benchOptions.qualityProfile = profile;
+                if (result.count("threads")) benchOptions.threadsOverride = result["threads"].as<int>();
+                AppConfig benchConfig = loadConfig(benchOptions.configPath, benchOptions);
+                EncoderBackends::RateControl rate{benchConfig.crf, benchConfig.videoBitrate,
+                                                  benchConfig.videoMaxRate, benchConfig.videoBufSize};
+                auto measured = EncoderBackends::benchmark(sample, seconds, benchOptions.encoder, benchOptions.preset, rate,
+                                                           benchConfig.pixelFormat, ThreadPolicy::resolve(benchConfig),
+                                                           std::make_shared<SystemProcessExecutor>());
+                measured.profile = profile;
+                results.push_back(measured);
+            }
+            std::cout << "\nProfile    Encoder     Preset     CRF  Speed   Size (kB)  kbit/s" << std::endl;
+            for (const auto& measured : results) {
+                std::cout << std::left << std::setw(11) << measured.profile << std::setw(12)
+                          << EncoderBackends::codecName(measured.encoder) << std::setw(11) << measured.preset
+                          << std::setw(5) << measured.crf;
+                if (measured.ok) {
+                    std::cout << std::fixed << std::setprecision(2) << std::setw(8) << measured.speed
+                              << std::setprecision(0) << std::setw(11) << measured.bytes / 1000.0 << measured.kbps;
+                } else {
+                    std::cout << "failed";
+                }
+                std::cout << std::endl;
+            }
+            for (const auto& measured : results) std::cout << "BENCHMARK " << measured.toJson().dump() << std::endl;
+            return std::all_of(results.begin(), results.end(), [](const auto& measured) { return measured.ok; }) ? 0 : 1;
+        } catch (const std::exception& e) {
+            std::cerr << "Benchmark failed: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     if (result.count("help") || !result.count("surah") || !result.count("from") || !result.count("to")) {
         std::cout << cli_parser.help() << std::endl;
         std::cout << "\nRecitation Modes:\n"
@@ -153,9 +274,79 @@ int main(int argc, char* argv[]) {
     if (result.count("translation-font-color")) options.translationFontColor = result["translation-font-color"].as<std::string>();
     options.noCache = result["no-cache"].as<bool>();
     options.clearCache = result["clear-cache"].as<bool>();
+    if (result.count("render-store")) options.renderStorePath = result["render-store"].as<std::string>();
+    if (result.count("renditions")) {
+        try {
+            options.variants = VideoGenerator::parseRenditions(result["renditions"].as<std::string>());
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    options.softSubtitles = result.count("soft-subtitles") > 0;
+    options.container = result["container"].as<std::string>();
+    if (options.container != "mp4" && options.container != "fmp4" && options.container != "hls") {
+        std::cerr << "Error: --container must be mp4, fmp4 or hls" << std::endl;
+        return 1;
+    }
+    if (options.softSubtitles && options.container == "hls") {
+        std::cerr << "Error: --soft-subtitles cannot be combined with --container hls" << std::endl;
+        return 1;
+    }
+    if (options.softSubtitles && std::any_of(options.variants.begin(), options.variants.end(),
+                                             [](const RenderVariant& variant) { return variant.width > 0; })) {
+        std::cerr << "Error: --soft-subtitles cannot be combined with --renditions" << std::endl;
+        return 1;
+    }
+    if (result.count("upload-r2")) options.uploadKey = result["upload-r2"].as<std::string>();
+    if (result.count("upload-bucket")) options.uploadBucket = result["upload-bucket"].as<std::string>();
+    if (result.count("translations")) {
+        try {
+            auto translations = VideoGenerator::parseTranslations(result["translations"].as<std::string>());
+            options.variants.insert(options.variants.end(), translations.begin(), translations.end());
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    // Soft-subtitle translations are tracks of the one file; anything else is a second output
+    if (!options.uploadKey.empty() && ((!options.variants.empty() && !options.softSubtitles) || options.container == "hls")) {
+        std::cerr << "Error: --upload-r2 streams a single file and cannot be combined with extra outputs or --container hls" << std::endl;
+        return 1;
+    }
     options.preset = result["preset"].as<std::string>();
     options.presetProvided = result.count("preset");
+    if (result.count("loop-memory-mb")) options.loopMemoryMb = result["loop-memory-mb"].as<int>();
+    options.staticBackground = result.count("static-bg") > 0;
+    options.prerenderText = result.count("prerender-text") > 0;
+    options.draft = result.count("draft") > 0;
+    if (result.count("deadline")) {
+        options.deadlineSeconds = result["deadline"].as<double>();
+        if (options.deadlineSeconds <= 0.0) {
+            std::cerr << "Error: --deadline must be a positive number of seconds" << std::endl;
+            return 1;
+        }
+        if (options.presetProvided || options.draft) {
+            std::cerr << "Error: --deadline chooses the preset and cannot be combined with --preset or --draft" << std::endl;
+            return 1;
+        }
+    }
+    if (options.draft) {
+        if (std::any_of(options.variants.begin(), options.variants.end(),
+                        [](const RenderVariant& variant) { return variant.width > 0; })) {
+            std::cerr << "Error: --draft cannot be combined with --renditions" << std::endl;
+            return 1;
+        }
+        // Speed over size; an explicit --preset still wins
+        if (!options.presetProvided) options.preset = "ultrafast";
+        options.presetProvided = true;
+    }
     options.encoder = result["encoder"].as<std::string>();
+    options.encoderProvided = result.count("encoder") > 0;
+    if (!EncoderBackends::isKnown(options.encoder)) {
+        std::cerr << "Error: --encoder must be software, x265, svt-av1 or hardware" << std::endl;
+        return 1;
+    }
     options.enableTextGrowth = !result["no-growth"].as<bool>();
     options.emitProgress = result["progress"].as<bool>();
 	options.showSurahHeader = result["show-surah-header"].as<bool>();
@@ -169,6 +360,8 @@ int main(int argc, char* argv[]) {
     if (result.count("video-bitrate")) options.videoBitrateOverride = result["video-bitrate"].as<std::string>();
     if (result.count("maxrate")) options.videoMaxRateOverride = result["maxrate"].as<std::string>();
     if (result.count("bufsize")) options.videoBufSizeOverride = result["bufsize"].as<std::string>();
+    if (result.count("threads")) options.threadsOverride = result["threads"].as<int>();
+    if (result.count("jobs")) options.jobsOverride = result["jobs"].as<int>();
     
     // Dynamic background video options
     options.videoSelection.seed = result["seed"].as<unsigned int>();
@@ -253,6 +446,13 @@ int main(int argc, char* argv[]) {
         
         AppConfig config = loadConfig(options.configPath, options);
 
+        // The main output already carries the configured translation
+        options.variants.erase(std::remove_if(options.variants.begin(), options.variants.end(),
+                                              [&](const RenderVariant& variant) {
+                                                  return variant.width == 0 && variant.translationId == config.translationId;
+                                              }),
+                               options.variants.end());
+
         // We want to allow gapless mode for custom audio
         if (config.recitationMode == RecitationMode::GAPLESS && options.customAudioPath.empty()) {
             std::cerr << gaplessDisabledError << std::endl;
@@ -293,9 +493,136 @@ int main(int argc, char* argv[]) {
         options.segmentDataPath
     );
 
-    MetadataWriter::writeMetadata(options, config, invocationArgs);
-    VideoGenerator::generateVideo(options, config, verses, processExecutor, segmentManager.get());
+    if (result.count("still")) {
+        std::string still = VideoGenerator::renderStill(options, config, verses, processExecutor,
+                                                        segmentManager.get(), result["still"].as<std::string>());
+        std::cout << "✅ Still saved to: " << still << std::endl;
+        return 0;
+    }
+
+    // --deadline picks the preset before the fingerprint, which includes it
+    fs::path historyPath = RenderHistory::defaultPath();
+    DeadlinePlanner::Job job{config.width, config.height, config.fps, 0.0};
+    VerseIndex::Index timeline = VerseIndex::build(options, config, verses);
+    if (!timeline.verses.empty()) job.seconds = timeline.verses.back().end;
+    RenderHistory::Entry proposed;
+    proposed.width = job.width;
+    proposed.height = job.height;
+    proposed.fps = job.fps;
+    proposed.videoSeconds = job.seconds;
+    proposed.inputs = static_cast<int>(verses.size());
+    proposed.prerenderText = options.prerenderText;
+    proposed.dynamicBackground = config.videoSelection.enableDynamicBackgrounds;
+    if (options.deadlineSeconds > 0.0) {
+        if (options.encoder != "software") {
+            std::cerr << "Warning: --deadline only applies to the libx264 software encoder; ignoring it" << std::endl;
+        } else {
+            ThreadPolicy::Allocation threads = ThreadPolicy::resolve(config);
+            auto history = RenderHistory::comparable(RenderHistory::load(historyPath), proposed);
+            // --estimate must not encode anything, so it plans from the history alone
+            DeadlinePlanner::Calibrate calibrate;
+            if (!result.count("estimate")) {
+                calibrate = [&](const std::string& preset) {
+                    return DeadlinePlanner::calibrate(preset, job, config.pixelFormat, threads, processExecutor, historyPath);
+                };
+            }
+            auto decision = DeadlinePlanner::choose(job, options.deadlineSeconds, history, calibrate);
+            if (decision.preset.empty()) {
+                std::cerr << "Warning: Could not estimate encode time; keeping preset '" << options.preset << "'" << std::endl;
+            } else {
+                std::cout << "Deadline " << options.deadlineSeconds << "s: preset '" << decision.preset << "', estimated "
+                          << static_cast<int>(decision.estimatedSeconds + 0.5) << "s for " << job.seconds
+                          << "s of video (" << decision.basis << ")" << std::endl;
+                if (!decision.fits) {
+                    std::cerr << "Warning: Even preset '" << decision.preset << "' is expected to miss the deadline" << std::endl;
+                }
+                options.preset = decision.preset;
+            }
+        }
+    }
+
+    proposed.preset = options.preset;
+    if (result.count("estimate")) {
+        if (options.encoder != "software") {
+            std::cerr << "Warning: The render history only covers the libx264 software encoder" << std::endl;
+        }
+        RenderHistory::Estimate estimate = RenderHistory::estimate(RenderHistory::load(historyPath), proposed);
+        if (estimate.known) {
+            std::cout << "Estimate for " << job.seconds << "s of " << job.width << "x" << job.height << "@" << job.fps
+                      << " with preset '" << proposed.preset << "': " << static_cast<int>(estimate.wallSeconds + 0.5)
+                      << "s wall, " << static_cast<int>(estimate.cpuSeconds + 0.5) << "s CPU, "
+                      << estimate.peakRssKb / 1024 << " MB peak (" << estimate.samples << " " << estimate.basis
+                      << (estimate.samples == 1 ? "" : "s") << ")" << std::endl;
+        } else {
+            std::cerr << "Warning: No render history for preset '" << proposed.preset << "' yet" << std::endl;
+        }
+        nlohmann::json line = estimate.toJson();
+        line["job"] = proposed.toJson();
+        std::cout << "ESTIMATE " << line.dump() << std::endl;
+        return estimate.known ? 0 : 1;
+    }
+
+    // Identical inputs produce an identical video; reuse a finished render when one exists
+    RenderCache::Fingerprint fingerprint;
+    fs::path renderStore;
+    // The store holds single-file renders; multi-output, soft-subtitle, HLS, uploaded and draft renders skip it
+    if (!options.noCache && options.variants.empty() && !options.softSubtitles && options.container != "hls" &&
+        options.uploadKey.empty() && !options.draft) {
+        if (config.videoSelection.enableDynamicBackgrounds) BackgroundVideo::refreshManifest(config);
+        fingerprint = RenderCache::compute(options, config, verses);
+        renderStore = RenderCache::storeRoot(options);
+        if (auto cached = RenderCache::lookup(renderStore, fingerprint.id)) {
+            fs::path finalPath = VideoGenerator::finalOutputPath(options);
+            if (RenderCache::restore(*cached, finalPath)) {
+                MetadataWriter::writeMetadata(options, config, invocationArgs, fingerprint.id, true);
+                // The sidecars of a render are written by generateVideo, which a reuse skips
+                VideoGenerator::generateThumbnail(options, config, processExecutor);
+                try {
+                    VerseIndex::write(timeline, finalPath);
+                } catch (const std::exception& e) {
+                    std::cerr << "Warning: " << e.what() << std::endl;
+                }
+                std::cout << "✅ Reused cached render " << fingerprint.id << ": " << finalPath << std::endl;
+                return 0;
+            }
+        }
+    }
+
+    if (!options.draft) MetadataWriter::writeMetadata(options, config, invocationArgs, fingerprint.id);
+    std::shared_ptr<Interfaces::IStreamUploader> uploader;
+    if (!options.uploadKey.empty()) {
+        // Credentials come from the background bucket settings; an http:// endpoint
+        // (e.g. a local MinIO) is used as is
+        R2::R2Config uploadConfig{
+            config.videoSelection.r2Endpoint,
+            config.videoSelection.r2AccessKey,
+            config.videoSelection.r2SecretKey,
+            options.uploadBucket.empty() ? config.videoSelection.r2Bucket : options.uploadBucket,
+            false
+        };
+        uploader = std::make_shared<R2StreamUploader>(uploadConfig);
+    }
+    VideoGenerator::EncodeStats encodeStats;
+    std::string rendered = VideoGenerator::generateVideo(options, config, verses, processExecutor, segmentManager.get(),
+                                                         uploader, &encodeStats);
+    // Frame encodes of software renders feed --deadline and --estimate for later runs
+    if (!rendered.empty() && options.encoder == "software" && encodeStats.videoSeconds > 0.0) {
+        proposed.videoSeconds = encodeStats.videoSeconds;
+        proposed.wallSeconds = encodeStats.wallSeconds;
+        proposed.cpuSeconds = encodeStats.cpuSeconds;
+        proposed.peakRssKb = RenderHistory::usage().peakRssKb;
+        RenderHistory::append(historyPath, proposed);
+    }
+    if (uploader && rendered.empty()) return 1;
+    if (options.draft) {
+        if (rendered.empty()) return 1;
+        std::cout << "✅ Draft preview: " << rendered << std::endl;
+        return 0;
+    }
     VideoGenerator::generateThumbnail(options, config, processExecutor);
+    if (!fingerprint.id.empty() && CacheUtils::fileIsValid(rendered)) {
+        RenderCache::save(renderStore, fingerprint, rendered);
+    }
 
     } catch (const std::exception& e) {
         std::cerr << "Fatal Error: " << e.what() << std::endl;
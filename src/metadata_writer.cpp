@@ -1,5 +1,6 @@
 #include "metadata_writer.h"
 #include "quran_data.h"
+#include "thread_policy.h"
 #include <cerrno>
 #include <chrono>
 #include <filesystem>
@@ -220,7 +221,9 @@ namespace MetadataWriter {
 
 void writeMetadata(const CLIOptions& options,
                    const AppConfig& config,
-                   const std::vector<std::string>& rawArgs) {
+                   const std::vector<std::string>& rawArgs,
+                   const std::string& renderFingerprint,
+                   bool reusedFromCache) {
     fs::path outputPath = options.output.empty() ? fs::path("out/render.mp4") : fs::path(options.output);
     fs::path metadataPath = outputPath;
     metadataPath.replace_extension(".metadata.json");
@@ -235,6 +238,13 @@ void writeMetadata(const CLIOptions& options,
     metadata["command"] = buildCommandBlock(rawArgs);
     metadata["paths"] = buildPathsBlock(options, config, metadataPath);
     metadata["artifacts"] = buildArtifactsBlock(options);
+    metadata["threads"] = ThreadPolicy::toJson(ThreadPolicy::resolve(config));
+    if (!renderFingerprint.empty()) {
+        metadata["render"] = {
+            {"fingerprint", renderFingerprint},
+            {"reusedFromCache", reusedFromCache}
+        };
+    }
 
     std::ofstream file(metadataPath);
     if (!file.is_open()) {
@@ -9,7 +9,9 @@ namespace MetadataWriter {
 
 void writeMetadata(const CLIOptions& options,
                    const AppConfig& config,
-                   const std::vector<std::string>& rawArgs);
+                   const std::vector<std::string>& rawArgs,
+                   const std::string& renderFingerprint = "",
+                   bool reusedFromCache = false);
 
 void generateBackendMetadata(const std::string& outputPath);
 
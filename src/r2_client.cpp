@@ -6,15 +6,36 @@
 #include <aws/s3/model/PutObjectRequest.h>
 #include <aws/s3/model/DeleteObjectRequest.h>
 #include <aws/s3/model/HeadObjectRequest.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
+#include <aws/s3/model/UploadPartRequest.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
+#include <aws/s3/model/CompletedMultipartUpload.h>
+#include <aws/s3/model/CompletedPart.h>
+#include <aws/core/http/HttpTypes.h>
 #include <aws/core/auth/AWSCredentials.h>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 namespace fs = std::filesystem;
 
 namespace R2 {
 
+namespace {
+
+// S3 requires every part except the last to be at least 5 MiB
+constexpr size_t kMultipartPartSize = 8 * 1024 * 1024;
+
+// A part is re-sent from the in-memory buffer this many times before the upload is aborted
+constexpr int kPartAttempts = 3;
+constexpr int kRetryBaseDelayMs = 500;
+
+} // namespace
+
 class Client::Impl {
 public:
     R2Config config;
@@ -26,7 +47,9 @@ public:
         
         Aws::Client::ClientConfiguration clientConfig;
         clientConfig.endpointOverride = extractHost(config.endpoint);
-        clientConfig.scheme = Aws::Http::Scheme::HTTPS;
+        // Plain http only for explicit endpoints such as a local S3-compatible stand-in (MinIO)
+        clientConfig.scheme = config.endpoint.rfind("http://", 0) == 0 ? Aws::Http::Scheme::HTTP
+                                                                       : Aws::Http::Scheme::HTTPS;
         clientConfig.region = "auto";
         
         if (config.usePublicAccess || config.accessKey.empty() || config.secretKey.empty()) {
@@ -75,32 +98,55 @@ Client::Client(const R2Config& config)
 
 Client::~Client() = default;
 
-std::vector<std::string> Client::listVideosInTheme(const std::string& theme) {
-    Aws::S3::Model::ListObjectsV2Request request;
-    request.SetBucket(pImpl->config.bucket);
-    request.SetPrefix(theme + "/");
+std::vector<ObjectInfo> Client::listObjects(const std::string& prefix) {
+    std::vector<ObjectInfo> objects;
+    Aws::String continuationToken;
     
-    auto outcome = pImpl->s3Client->ListObjectsV2(request);
-    
-    if (!outcome.IsSuccess()) {
-        auto& error = outcome.GetError();
-        throw std::runtime_error(
-            "Failed to list videos in theme '" + theme + "': " + 
-            error.GetExceptionName() + " - " + error.GetMessage()
-        );
-    }
+    // ListObjectsV2 returns at most 1000 keys per page
+    do {
+        Aws::S3::Model::ListObjectsV2Request request;
+        request.SetBucket(pImpl->config.bucket);
+        request.SetPrefix(prefix);
+        if (!continuationToken.empty()) {
+            request.SetContinuationToken(continuationToken);
+        }
+        
+        auto outcome = pImpl->s3Client->ListObjectsV2(request);
+        
+        if (!outcome.IsSuccess()) {
+            auto& error = outcome.GetError();
+            throw std::runtime_error(
+                "Failed to list objects under '" + prefix + "': " + 
+                error.GetExceptionName() + " - " + error.GetMessage()
+            );
+        }
+        
+        const auto& result = outcome.GetResult();
+        for (const auto& object : result.GetContents()) {
+            ObjectInfo info;
+            info.key = object.GetKey();
+            info.etag = object.GetETag();
+            info.etag.erase(std::remove(info.etag.begin(), info.etag.end(), '"'), info.etag.end());
+            info.size = object.GetSize();
+            objects.push_back(info);
+        }
+        
+        continuationToken = result.GetIsTruncated() ? result.GetNextContinuationToken() : "";
+    } while (!continuationToken.empty());
     
+    return objects;
+}
+
+std::vector<std::string> Client::listVideosInTheme(const std::string& theme) {
     std::vector<std::string> videos;
-    const auto& objects = outcome.GetResult().GetContents();
     
-    for (const auto& object : objects) {
-        std::string key = object.GetKey();
-        std::string ext = fs::path(key).extension().string();
+    for (const auto& object : listObjects(theme + "/")) {
+        std::string ext = fs::path(object.key).extension().string();
         std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
         
         if (ext == ".mp4" || ext == ".mov" || ext == ".avi" || 
             ext == ".mkv" || ext == ".webm") {
-            videos.push_back(key);
+            videos.push_back(object.key);
         }
     }
     
@@ -205,6 +251,137 @@ bool Client::uploadVideo(const fs::path& localPath, const std::string& key) {
     return true;
 }
 
+bool Client::uploadStream(const ChunkReader& reader, const std::string& key,
+                          const std::string& contentType) {
+    Aws::S3::Model::CreateMultipartUploadRequest createRequest;
+    createRequest.SetBucket(pImpl->config.bucket);
+    createRequest.SetKey(key);
+    createRequest.SetContentType(contentType);
+    
+    auto createOutcome = pImpl->s3Client->CreateMultipartUpload(createRequest);
+    if (!createOutcome.IsSuccess()) {
+        auto& error = createOutcome.GetError();
+        std::cerr << "Multipart upload failed to start for " << key << ": "
+                  << error.GetExceptionName() << " - " << error.GetMessage() << std::endl;
+        return false;
+    }
+    const Aws::String uploadId = createOutcome.GetResult().GetUploadId();
+    
+    auto abortUpload = [&](const std::string& reason) {
+        std::cerr << "Stream upload failed for " << key << ": " << reason << std::endl;
+        Aws::S3::Model::AbortMultipartUploadRequest abortRequest;
+        abortRequest.SetBucket(pImpl->config.bucket);
+        abortRequest.SetKey(key);
+        abortRequest.SetUploadId(uploadId);
+        pImpl->s3Client->AbortMultipartUpload(abortRequest);
+        return false;
+    };
+    
+    Aws::S3::Model::CompletedMultipartUpload completed;
+    std::vector<char> buffer(kMultipartPartSize);
+    int partNumber = 1;
+    long long totalBytes = 0;
+    bool endOfStream = false;
+    
+    try {
+        while (!endOfStream) {
+            // Fill a whole part; pipes return short reads
+            size_t filled = 0;
+            while (filled < buffer.size()) {
+                size_t count = reader(buffer.data() + filled, buffer.size() - filled);
+                if (count == 0) {
+                    endOfStream = true;
+                    break;
+                }
+                filled += count;
+            }
+            if (filled == 0) {
+                if (partNumber == 1) return abortUpload("stream was empty");
+                break;
+            }
+            
+            // The pipe cannot be rewound, so a failed part is retried from the buffer
+            Aws::String etag;
+            std::string lastError;
+            for (int attempt = 1; attempt <= kPartAttempts && etag.empty(); ++attempt) {
+                auto body = Aws::MakeShared<Aws::StringStream>("UploadPartAllocation");
+                body->write(buffer.data(), static_cast<std::streamsize>(filled));
+
+                Aws::S3::Model::UploadPartRequest partRequest;
+                partRequest.SetBucket(pImpl->config.bucket);
+                partRequest.SetKey(key);
+                partRequest.SetUploadId(uploadId);
+                partRequest.SetPartNumber(partNumber);
+                partRequest.SetContentLength(static_cast<long long>(filled));
+                partRequest.SetBody(body);
+
+                auto partOutcome = pImpl->s3Client->UploadPart(partRequest);
+                if (partOutcome.IsSuccess()) {
+                    etag = partOutcome.GetResult().GetETag();
+                    break;
+                }
+                auto& error = partOutcome.GetError();
+                lastError = error.GetExceptionName() + " - " + error.GetMessage();
+                if (attempt < kPartAttempts) {
+                    std::cerr << "  Part " << partNumber << " of " << key << " failed (" << lastError
+                              << "), retrying" << std::endl;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(kRetryBaseDelayMs << (attempt - 1)));
+                }
+            }
+            if (etag.empty()) {
+                return abortUpload("part " + std::to_string(partNumber) + ": " + lastError);
+            }
+
+            Aws::S3::Model::CompletedPart part;
+            part.SetPartNumber(partNumber);
+            part.SetETag(etag);
+            completed.AddParts(part);
+            totalBytes += static_cast<long long>(filled);
+            partNumber++;
+        }
+    } catch (const std::exception& e) {
+        return abortUpload(e.what());
+    }
+    
+    Aws::S3::Model::CompleteMultipartUploadRequest completeRequest;
+    completeRequest.SetBucket(pImpl->config.bucket);
+    completeRequest.SetKey(key);
+    completeRequest.SetUploadId(uploadId);
+    completeRequest.SetMultipartUpload(completed);
+    
+    auto completeOutcome = pImpl->s3Client->CompleteMultipartUpload(completeRequest);
+    if (!completeOutcome.IsSuccess()) {
+        auto& error = completeOutcome.GetError();
+        return abortUpload(error.GetExceptionName() + " - " + error.GetMessage());
+    }
+    
+    // Verify the assembled object really holds every byte that was streamed
+    Aws::S3::Model::HeadObjectRequest headRequest;
+    headRequest.SetBucket(pImpl->config.bucket);
+    headRequest.SetKey(key);
+    auto headOutcome = pImpl->s3Client->HeadObject(headRequest);
+    if (!headOutcome.IsSuccess()) {
+        auto& error = headOutcome.GetError();
+        std::cerr << "Stream upload of " << key << " could not be verified: "
+                  << error.GetExceptionName() << " - " << error.GetMessage() << std::endl;
+        return false;
+    }
+    long long stored = headOutcome.GetResult().GetContentLength();
+    if (stored != totalBytes) {
+        std::cerr << "Stream upload of " << key << " is incomplete: " << stored << " of "
+                  << totalBytes << " bytes stored" << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+std::string Client::presignedGetUrl(const std::string& key, long long expirySeconds) {
+    return pImpl->s3Client->GeneratePresignedUrl(
+        pImpl->config.bucket, key, Aws::Http::HttpMethod::HTTP_GET,
+        static_cast<uint64_t>(expirySeconds));
+}
+
 bool Client::deleteObject(const std::string& key) {
     Aws::S3::Model::DeleteObjectRequest request;
     request.SetBucket(pImpl->config.bucket);
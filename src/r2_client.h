@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <functional>
 #include <memory>
 
 namespace R2 {
@@ -14,11 +15,25 @@ struct R2Config {
     bool usePublicAccess = true;
 };
 
+// Listing entry with the metadata needed for change detection
+struct ObjectInfo {
+    std::string key;
+    std::string etag;   // without surrounding quotes
+    long long size = 0;
+};
+
+// Fills the buffer with up to `size` bytes and returns the count; 0 signals end of stream.
+// Throwing aborts the upload.
+using ChunkReader = std::function<size_t(char* buffer, size_t size)>;
+
 class Client {
 public:
     explicit Client(const R2Config& config);
     ~Client();
 
+    // List every object under a prefix (follows continuation tokens)
+    std::vector<ObjectInfo> listObjects(const std::string& prefix);
+
     // List all video files in a theme directory
     std::vector<std::string> listVideosInTheme(const std::string& theme);
     
@@ -31,6 +46,13 @@ public:
     // Upload video from local path
     bool uploadVideo(const std::filesystem::path& localPath, const std::string& key);
     
+    // Upload a stream of unknown length as a multipart upload, one part at a time
+    bool uploadStream(const ChunkReader& reader, const std::string& key,
+                      const std::string& contentType = "video/mp4");
+
+    // Time-limited GET URL so external tools (ffmpeg) can read an object directly
+    std::string presignedGetUrl(const std::string& key, long long expirySeconds = 3600);
+    
     // Delete object from bucket
     bool deleteObject(const std::string& key);
     
@@ -0,0 +1,255 @@
+#include "render_cache.h"
+#include "cache_utils.h"
+#include "background_video_manager.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <system_error>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace RenderCache {
+
+namespace {
+
+// Bump when a pipeline change alters the output for identical inputs
+constexpr int kFingerprintVersion = 1;
+
+json fontJson(const FontConfig& font) {
+    return {{"family", font.family}, {"file", font.file}, {"size", font.size}, {"color", font.color}};
+}
+
+// Large inputs are identified by path, size and mtime instead of contents
+json statFile(const std::string& path) {
+    json info = {{"path", path}};
+    std::error_code ec;
+    if (path.empty() || !fs::exists(path, ec)) {
+        info["missing"] = true;
+        return info;
+    }
+    info["size"] = fs::file_size(path, ec);
+    info["modified"] = static_cast<long long>(fs::last_write_time(path, ec).time_since_epoch().count());
+    return info;
+}
+
+std::string hashIfPresent(const std::string& path, std::map<std::string, std::string>& memo) {
+    if (path.empty()) return "";
+    auto it = memo.find(path);
+    if (it != memo.end()) return it->second;
+    std::string hash;
+    std::error_code ec;
+    if (fs::exists(path, ec)) {
+        try {
+            hash = CacheUtils::hashFile(path);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Could not hash " << path << ": " << e.what() << std::endl;
+        }
+    }
+    memo[path] = hash;
+    return hash;
+}
+
+// Every file of a clip library (clips, renditions, metadata.json) by size and mtime,
+// so replacing a clip in place invalidates renders that may have used it
+json describeLibrary(const std::string& directory) {
+    json files = json::object();
+    std::error_code ec;
+    if (directory.empty() || !fs::is_directory(directory, ec)) return files;
+
+    std::vector<fs::path> paths;
+    for (const auto& entry : fs::recursive_directory_iterator(directory, ec)) {
+        if (entry.is_regular_file()) paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end());
+    for (const auto& path : paths) {
+        json info = statFile(path.string());
+        info.erase("path");
+        files[fs::relative(path, directory).generic_string()] = info;
+    }
+    return files;
+}
+
+json describeConfig(const AppConfig& config) {
+    json data;
+    data["width"] = config.width;
+    data["height"] = config.height;
+    data["fps"] = config.fps;
+    data["reciterId"] = config.reciterId;
+    data["translationId"] = config.translationId;
+    data["translationIsRtl"] = config.translationIsRtl;
+    data["recitationMode"] = config.recitationMode == RecitationMode::GAPLESS ? "gapless" : "gapped";
+    data["arabicFont"] = fontJson(config.arabicFont);
+    data["translationFont"] = fontJson(config.translationFont);
+    data["surahHeaderFont"] = fontJson(config.surahHeaderFont);
+    data["translationFallbackFontFamily"] = config.translationFallbackFontFamily;
+    data["overlayColor"] = config.overlayColor;
+    data["introDuration"] = config.introDuration;
+    data["pauseAfterIntroDuration"] = config.pauseAfterIntroDuration;
+    data["introFadeOutMs"] = config.introFadeOutMs;
+    data["enableTextGrowth"] = config.enableTextGrowth;
+    data["textGrowthThreshold"] = config.textGrowthThreshold;
+    data["maxGrowthFactor"] = config.maxGrowthFactor;
+    data["growthRateFactor"] = config.growthRateFactor;
+    data["fadeDurationFactor"] = config.fadeDurationFactor;
+    data["minFadeDuration"] = config.minFadeDuration;
+    data["maxFadeDuration"] = config.maxFadeDuration;
+    data["textWrapThreshold"] = config.textWrapThreshold;
+    data["arabicMaxWidthFraction"] = config.arabicMaxWidthFraction;
+    data["translationMaxWidthFraction"] = config.translationMaxWidthFraction;
+    data["textHorizontalPadding"] = config.textHorizontalPadding;
+    data["textVerticalPadding"] = config.textVerticalPadding;
+    data["verticalShift"] = config.verticalShift;
+    data["crf"] = config.crf;
+    data["pixelFormat"] = config.pixelFormat;
+    data["videoBitrate"] = config.videoBitrate;
+    data["videoMaxRate"] = config.videoMaxRate;
+    data["videoBufSize"] = config.videoBufSize;
+    return data;
+}
+
+json describeBackground(const AppConfig& config, std::map<std::string, std::string>& memo) {
+    const auto& selection = config.videoSelection;
+    json data;
+    if (!selection.enableDynamicBackgrounds) {
+        data["static"] = statFile(config.assetBgVideo);
+        return data;
+    }
+    // Selection is deterministic for a seed, theme table and clip library
+    data["seed"] = selection.seed;
+    data["themeMetadata"] = hashIfPresent(selection.themeMetadataPath, memo);
+    if (selection.useLocalDirectory) {
+        data["localVideoDirectory"] = selection.localVideoDirectory;
+        data["library"] = describeLibrary(selection.localVideoDirectory);
+    } else {
+        data["r2Endpoint"] = selection.r2Endpoint;
+        data["r2Bucket"] = selection.r2Bucket;
+        // The cached copy is rewritten on every refresh, so only its contents are stable
+        data["manifest"] = hashIfPresent(BackgroundVideo::manifestPath(config).string(), memo);
+    }
+    data["fallback"] = statFile(config.assetBgVideo);
+    return data;
+}
+
+json describeFonts(const AppConfig& config, std::map<std::string, std::string>& memo) {
+    json fonts = json::object();
+    fs::path fontsDir = fs::path(config.assetFolderPath) / "fonts";
+    std::error_code ec;
+    if (!fs::is_directory(fontsDir, ec)) return fonts;
+
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::recursive_directory_iterator(fontsDir, ec)) {
+        if (entry.is_regular_file()) files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        fonts[fs::relative(file, fontsDir).generic_string()] = hashIfPresent(file.string(), memo);
+    }
+    return fonts;
+}
+
+} // namespace
+
+Fingerprint compute(const CLIOptions& options,
+                    const AppConfig& config,
+                    const std::vector<VerseData>& verses) {
+    std::map<std::string, std::string> fileHashes;
+    json versesJson = json::array();
+    for (const auto& verse : verses) {
+        json words = json::array();
+        for (const auto& word : verse.wordSegments) {
+            words.push_back({word.wordIndex, word.startMs, word.endMs});
+        }
+        versesJson.push_back({
+            {"verseKey", verse.verseKey},
+            {"text", verse.text},
+            {"translation", verse.translation},
+            {"duration", verse.durationInSeconds},
+            {"timestampFromMs", verse.timestampFromMs},
+            {"timestampToMs", verse.timestampToMs},
+            {"words", words},
+            {"fromCustomAudio", verse.fromCustomAudio},
+            // Gapless verses share one file; the memo hashes it once
+            {"audio", hashIfPresent(verse.localAudioPath, fileHashes)}
+        });
+    }
+
+    json inputs;
+    inputs["version"] = kFingerprintVersion;
+    inputs["range"] = {{"surah", options.surah}, {"from", options.from}, {"to", options.to}};
+    inputs["verses"] = versesJson;
+    inputs["config"] = describeConfig(config);
+    inputs["options"] = {
+        {"showSurahHeader", options.showSurahHeader},
+        {"surahHeaderFontSize", options.surahHeaderFontSize},
+        {"surahHeaderMarginTop", options.surahHeaderMarginTop},
+        {"skipStartBismillah", options.skipStartBismillah},
+        {"container", options.container},
+        {"staticBackground", options.staticBackground},
+        {"prerenderText", options.prerenderText},
+        {"segmentLongVerses", options.segmentLongVerses},
+        {"segmentData", options.segmentLongVerses ? hashIfPresent(options.segmentDataPath, fileHashes) : ""},
+        {"longVerses", options.segmentLongVerses ? hashIfPresent(options.longVersesPath, fileHashes) : ""}
+    };
+    inputs["encoder"] = {{"encoder", options.encoder}, {"preset", options.preset}};
+    inputs["fonts"] = describeFonts(config, fileHashes);
+    inputs["background"] = describeBackground(config, fileHashes);
+
+    Fingerprint fingerprint;
+    fingerprint.id = CacheUtils::hashString(inputs.dump());
+    fingerprint.inputs = std::move(inputs);
+    return fingerprint;
+}
+
+json describeFonts(const AppConfig& config) {
+    std::map<std::string, std::string> fileHashes;
+    return describeFonts(config, fileHashes);
+}
+
+fs::path storeRoot(const CLIOptions& options) {
+    if (!options.renderStorePath.empty()) return fs::path(options.renderStorePath);
+    return CacheUtils::getCacheRoot() / "renders";
+}
+
+std::optional<fs::path> lookup(const fs::path& store, const std::string& id) {
+    fs::path video = store / (id + ".mp4");
+    if (CacheUtils::fileIsValid(video)) return video;
+    return std::nullopt;
+}
+
+bool save(const fs::path& store, const Fingerprint& fingerprint, const fs::path& video) {
+    try {
+        fs::create_directories(store);
+        // Copy under a temporary name so concurrent readers never see a partial file
+        fs::path target = store / (fingerprint.id + ".mp4");
+        fs::path temp = target;
+        temp += ".tmp";
+        fs::copy_file(video, temp, fs::copy_options::overwrite_existing);
+        fs::rename(temp, target);
+
+        std::ofstream record(store / (fingerprint.id + ".json"));
+        record << json{{"fingerprint", fingerprint.id}, {"inputs", fingerprint.inputs}}.dump(2) << '\n';
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: Could not store render in " << store << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool restore(const fs::path& cached, const fs::path& destination) {
+    std::error_code ec;
+    if (!destination.parent_path().empty()) fs::create_directories(destination.parent_path(), ec);
+    fs::remove(destination, ec);
+    // Always a copy: a hard link would let later edits or overwrites of the output
+    // (ffmpeg -y truncates in place) corrupt the stored render
+    ec.clear();
+    fs::copy_file(cached, destination, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
+        std::cerr << "Warning: Could not restore cached render: " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace RenderCache
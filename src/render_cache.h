@@ -0,0 +1,39 @@
+#pragma once
+#include "types.h"
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace RenderCache {
+
+// Identity of a render: every input that can change the output video
+struct Fingerprint {
+    std::string id;          // hash of `inputs`, used as the store key
+    nlohmann::json inputs;   // canonical description, stored alongside cached renders
+};
+
+// With an R2 clip library, call BackgroundVideo::refreshManifest first so the fingerprint
+// covers the manifest the render will use
+Fingerprint compute(const CLIOptions& options,
+                    const AppConfig& config,
+                    const std::vector<VerseData>& verses);
+
+// Content hashes of the bundled fonts, keyed by path relative to the fonts folder
+nlohmann::json describeFonts(const AppConfig& config);
+
+// --render-store when given (e.g. a shared mount), otherwise <cache root>/renders
+std::filesystem::path storeRoot(const CLIOptions& options);
+
+// Previously rendered video for this fingerprint, if the store has one
+std::optional<std::filesystem::path> lookup(const std::filesystem::path& store, const std::string& id);
+
+// Copy a finished render into the store; returns false (with a warning) on failure
+bool save(const std::filesystem::path& store, const Fingerprint& fingerprint,
+          const std::filesystem::path& video);
+
+// Copy a cached render to destination, independent of the store entry
+bool restore(const std::filesystem::path& cached, const std::filesystem::path& destination);
+
+} // namespace RenderCache
@@ -0,0 +1,191 @@
+#include "render_history.h"
+#include "cache_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <system_error>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace RenderHistory {
+
+namespace {
+
+double pixels(const Entry& entry) {
+    return static_cast<double>(entry.width) * entry.height * entry.fps * entry.videoSeconds;
+}
+
+template <typename T>
+T median(std::vector<T> values) {
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+} // namespace
+
+double Entry::pixelRate() const {
+    if (wallSeconds <= 0.0 || videoSeconds <= 0.0) return 0.0;
+    return pixels(*this) / wallSeconds;
+}
+
+bool Entry::comparableTo(const Entry& job) const {
+    if (source != "render") return true;
+    return prerenderText == job.prerenderText && dynamicBackground == job.dynamicBackground;
+}
+
+json Entry::toJson() const {
+    return {
+        {"source", source},
+        {"preset", preset},
+        {"width", width},
+        {"height", height},
+        {"fps", fps},
+        {"videoSeconds", videoSeconds},
+        {"wallSeconds", wallSeconds},
+        {"inputs", inputs},
+        {"cpuSeconds", cpuSeconds},
+        {"peakRssKb", peakRssKb},
+        {"prerenderText", prerenderText},
+        {"dynamicBackground", dynamicBackground}
+    };
+}
+
+Entry Entry::fromJson(const json& data) {
+    Entry entry;
+    entry.source = data.value("source", "render");
+    entry.preset = data.value("preset", "");
+    entry.width = data.value("width", 0);
+    entry.height = data.value("height", 0);
+    entry.fps = data.value("fps", 0);
+    entry.videoSeconds = data.value("videoSeconds", 0.0);
+    entry.wallSeconds = data.value("wallSeconds", 0.0);
+    entry.inputs = data.value("inputs", 0);
+    entry.cpuSeconds = data.value("cpuSeconds", 0.0);
+    entry.peakRssKb = data.value("peakRssKb", 0L);
+    entry.prerenderText = data.value("prerenderText", false);
+    entry.dynamicBackground = data.value("dynamicBackground", false);
+    return entry;
+}
+
+Usage usage() {
+    Usage total;
+#ifndef _WIN32
+    // Children only count once waited for, which the process executor does for every ffmpeg
+    for (int who : {RUSAGE_SELF, RUSAGE_CHILDREN}) {
+        struct rusage usage {};
+        if (getrusage(who, &usage) != 0) continue;
+        total.cpuSeconds += usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                            usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#if defined(__APPLE__)
+        long rssKb = static_cast<long>(usage.ru_maxrss / 1024);  // bytes on macOS
+#else
+        long rssKb = static_cast<long>(usage.ru_maxrss);
+#endif
+        total.peakRssKb = std::max(total.peakRssKb, rssKb);
+    }
+#endif
+    return total;
+}
+
+json Estimate::toJson() const {
+    return {
+        {"known", known},
+        {"wallSeconds", wallSeconds},
+        {"cpuSeconds", cpuSeconds},
+        {"peakRssKb", peakRssKb},
+        {"samples", samples},
+        {"basis", basis}
+    };
+}
+
+std::vector<Entry> comparable(const std::vector<Entry>& history, const Entry& job) {
+    std::vector<Entry> entries;
+    std::copy_if(history.begin(), history.end(), std::back_inserter(entries),
+                 [&](const Entry& entry) { return entry.comparableTo(job); });
+    return entries;
+}
+
+Estimate estimate(const std::vector<Entry>& history, const Entry& job) {
+    Estimate result;
+    std::vector<const Entry*> matches;
+    for (const char* source : {"render", "calibration"}) {
+        for (const auto& entry : history) {
+            if (entry.source == source && entry.preset == job.preset && entry.comparableTo(job) &&
+                entry.pixelRate() > 0.0) {
+                matches.push_back(&entry);
+            }
+        }
+        if (!matches.empty()) {
+            result.basis = source;
+            break;
+        }
+    }
+    if (matches.empty() || pixels(job) <= 0.0) return result;
+
+    std::vector<double> wallPerPixel, cpuPerPixel;
+    for (const Entry* entry : matches) {
+        wallPerPixel.push_back(entry->wallSeconds / pixels(*entry));
+        if (entry->cpuSeconds > 0.0) cpuPerPixel.push_back(entry->cpuSeconds / pixels(*entry));
+    }
+    result.known = true;
+    result.samples = static_cast<int>(matches.size());
+    result.wallSeconds = median(wallPerPixel) * pixels(job);
+    if (!cpuPerPixel.empty()) result.cpuSeconds = median(cpuPerPixel) * pixels(job);
+
+    // Memory follows the frame size (decoded frames, lookahead), not the video length
+    double area = static_cast<double>(job.width) * job.height;
+    double closest = -1.0;
+    std::vector<long> rss;
+    for (const Entry* entry : matches) {
+        if (entry->peakRssKb <= 0) continue;
+        double distance = std::abs(static_cast<double>(entry->width) * entry->height - area);
+        if (closest < 0.0 || distance < closest) {
+            closest = distance;
+            rss.clear();
+        }
+        if (distance == closest) rss.push_back(entry->peakRssKb);
+    }
+    if (!rss.empty()) result.peakRssKb = median(rss);
+    return result;
+}
+
+fs::path defaultPath() {
+    return CacheUtils::getCacheRoot() / "render_history.jsonl";
+}
+
+std::vector<Entry> load(const fs::path& path) {
+    std::vector<Entry> entries;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        try {
+            entries.push_back(Entry::fromJson(json::parse(line)));
+        } catch (const std::exception&) {
+            // A run killed mid-write leaves a partial last line
+        }
+    }
+    return entries;
+}
+
+bool append(const fs::path& path, const Entry& entry) {
+    std::error_code ec;
+    if (!path.parent_path().empty()) fs::create_directories(path.parent_path(), ec);
+    std::ofstream file(path, std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "Warning: Could not write render history " << path << std::endl;
+        return false;
+    }
+    file << entry.toJson().dump() << '\n';
+    return true;
+}
+
+} // namespace RenderHistory
@@ -0,0 +1,74 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Local record of finished encodes (one JSON object per line), used to predict how
+// long an encode will take on this host and what it will cost. Renders record only the
+// ffmpeg commands that encoded frames, not cache hits, muxes or background downloads.
+namespace RenderHistory {
+
+struct Entry {
+    std::string source = "render";  // "render" or "calibration"
+    std::string preset;
+    int width = 0;
+    int height = 0;
+    int fps = 0;
+    double videoSeconds = 0.0;      // length of the encoded video
+    double wallSeconds = 0.0;       // time the encode took
+    int inputs = 0;                 // verses rendered
+    double cpuSeconds = 0.0;        // user + system time of qvm and its ffmpeg children (0 = unknown)
+    long peakRssKb = 0;             // largest resident set of qvm or any child (0 = unknown)
+    bool prerenderText = false;     // --prerender-text overlays instead of libass on every frame
+    bool dynamicBackground = false; // clip timeline instead of one looped background
+
+    // Encoded pixels per wall-clock second, or 0 for an unusable entry
+    double pixelRate() const;
+
+    // Whether this entry predicts the cost of job: calibrations time the encoder alone and
+    // fit any job, renders only jobs with the same text and background pipeline
+    bool comparableTo(const Entry& job) const;
+
+    nlohmann::json toJson() const;
+    static Entry fromJson(const nlohmann::json& data);
+};
+
+// CPU time and peak memory of this process and its finished children so far
+struct Usage {
+    double cpuSeconds = 0.0;
+    long peakRssKb = 0;
+};
+Usage usage();
+
+// Predicted cost of an encode
+struct Estimate {
+    bool known = false;             // false when the history has nothing for the preset
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0;        // 0 when no matching entry recorded it
+    long peakRssKb = 0;
+    int samples = 0;                // history entries the wall time is based on
+    std::string basis;              // "render" or "calibration"
+
+    nlohmann::json toJson() const;
+};
+
+// The entries comparable to job
+std::vector<Entry> comparable(const std::vector<Entry>& history, const Entry& job);
+
+// Scales the median per-pixel wall and CPU time of the job's preset (over the comparable
+// entries) to the job's pixel count (width x height x fps x videoSeconds); peak memory comes from the entries
+// closest in frame size. Renders are preferred over calibrations, which time only the
+// encoder and record neither CPU nor memory.
+Estimate estimate(const std::vector<Entry>& history, const Entry& job);
+
+// <cache root>/render_history.jsonl
+std::filesystem::path defaultPath();
+
+// Every readable entry; a missing file is an empty history, malformed lines are skipped
+std::vector<Entry> load(const std::filesystem::path& path);
+
+// Adds one line; returns false (with a warning) when the file cannot be written
+bool append(const std::filesystem::path& path, const Entry& entry);
+
+} // namespace RenderHistory
@@ -116,8 +116,10 @@ std::string buildAssFile(const AppConfig& config,
                          const std::vector<VerseData>& verses,
                          double intro_duration,
                          double pause_after_intro_duration,
-                         const VerseSegmentation::Manager* segmentManager) {
-    fs::path ass_path = fs::temp_directory_path() / "subtitles.ass";
+                         const VerseSegmentation::Manager* segmentManager,
+                         const std::string& fileName,
+                         Layers layers) {
+    fs::path ass_path = fs::temp_directory_path() / fileName;
     std::ofstream ass_file(ass_path);
     if (!ass_file.is_open()) throw std::runtime_error("Failed to create temporary subtitle file.");
 
@@ -139,10 +141,15 @@ std::string buildAssFile(const AppConfig& config,
     double paddingPixels = layoutEngine.paddingPixels();
     int styleMargin = std::max(10, static_cast<int>(paddingPixels));
 
+    bool withArabic = layers != Layers::Translation;
+    bool withTranslation = layers != Layers::Arabic;
+    // The Arabic-only file is burned into a cached picture, so nothing in it may name the translation
+    std::string event_style = withTranslation ? "Translation" : "Arabic";
+
     ass_file << "[V4+ Styles]\n";
     ass_file << "Format: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, Bold, Italic, Underline, StrikeOut, ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\n";
     ass_file << "Style: Arabic," << config.arabicFont.family << "," << config.arabicFont.size << "," << format_ass_color(config.arabicFont.color) << ",&H000000FF,&H00000000,&H99000000,0,0,0,0,100,100,0,0,1,1,1,5," << styleMargin << "," << styleMargin << "," << config.arabicFont.size * 1.5 << ",-1\n";
-    ass_file << "Style: Translation," << config.translationFont.family << "," << config.translationFont.size << "," << format_ass_color(config.translationFont.color) << ",&H000000FF,&H00000000,&H99000000,0,0,0,0,100,100,0,0,1,1,1,5," << styleMargin << "," << styleMargin << "," << config.height / 2 + config.translationFont.size << ",-1\n\n";
+    if (withTranslation) ass_file << "Style: Translation," << config.translationFont.family << "," << config.translationFont.size << "," << format_ass_color(config.translationFont.color) << ",&H000000FF,&H00000000,&H99000000,0,0,0,0,100,100,0,0,1,1,1,5," << styleMargin << "," << styleMargin << "," << config.height / 2 + config.translationFont.size << ",-1\n\n";
     ass_file << "[Events]\n";
     ass_file << "Format: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n";
     
@@ -153,25 +160,28 @@ std::string buildAssFile(const AppConfig& config,
     int scaled_font_size = static_cast<int>(base_font_size * (config.width * 0.7 / (base_font_size * 6.0)));
     if (scaled_font_size < base_font_size) scaled_font_size = base_font_size;
 
-    ass_file << "Dialogue: 0,0:00:00.00," << format_time_ass(intro_duration)
-            << ",Translation,,0,0,0,,{\\an5\\pos(" << config.width/2 << "," << config.height/2 << ")"
-            << "\\fs" << scaled_font_size
-            << "\\b1\\bord4\\shad3\\be2\\c&HFFFFFF&\\3c&H000000&"
-            << "\\fad(0," << config.introFadeOutMs << ")}" << localized_surah_text_render << "\n";
+    // The intro card is localized, so it travels with the translation
+    if (withTranslation) {
+        ass_file << "Dialogue: 0,0:00:00.00," << format_time_ass(intro_duration)
+                << ",Translation,,0,0,0,,{\\an5\\pos(" << config.width/2 << "," << config.height/2 << ")"
+                << "\\fs" << scaled_font_size
+                << "\\b1\\bord4\\shad3\\be2\\c&HFFFFFF&\\3c&H000000&"
+                << "\\fad(0," << config.introFadeOutMs << ")}" << localized_surah_text_render << "\n";
 
-    std::string range_text = LocalizationUtils::getLocalizedNumber(options.surah, language_code) +
-                             " • " + std::to_string(options.from) + "-" + std::to_string(options.to);
+        std::string range_text = LocalizationUtils::getLocalizedNumber(options.surah, language_code) +
+                                 " • " + std::to_string(options.from) + "-" + std::to_string(options.to);
     
-    range_text = applyLatinFontFallback(range_text,
-                                        config.translationFallbackFontFamily,
-                                        config.translationFont.family);
-
-    ass_file << "Dialogue: 0,0:00:00.00," << format_time_ass(intro_duration)
-            << ",Translation,,0,0,0,,{\\an5\\pos(" << config.width/2 << "," << config.height/2 + scaled_font_size*1.5 << ")"
-            << "\\fs" << scaled_font_size/2
-            << "\\b0\\bord2\\shad1\\be1\\c&HFFFFFF&\\3c&H000000&"
-            << "\\fad(0," << config.introFadeOutMs << ")}"
-            << range_text << "\n";
+        range_text = applyLatinFontFallback(range_text,
+                                            config.translationFallbackFontFamily,
+                                            config.translationFont.family);
+
+        ass_file << "Dialogue: 0,0:00:00.00," << format_time_ass(intro_duration)
+                << ",Translation,,0,0,0,,{\\an5\\pos(" << config.width/2 << "," << config.height/2 + scaled_font_size*1.5 << ")"
+                << "\\fs" << scaled_font_size/2
+                << "\\b0\\bord2\\shad1\\be1\\c&HFFFFFF&\\3c&H000000&"
+                << "\\fad(0," << config.introFadeOutMs << ")}"
+                << range_text << "\n";
+    }
 
     // Collect all dialogue entries (verses and segments)
     std::vector<SegmentDialogue> allDialogues;
@@ -183,7 +193,7 @@ std::string buildAssFile(const AppConfig& config,
 	}  
 	  
 	// Persistent header with surah name - shows throughout entire video if enabled  
-	if (options.showSurahHeader) {  
+	if (options.showSurahHeader && withArabic) {  
 		// Use custom font size and margin from CLI options  
 		int header_font_size = options.surahHeaderFontSize;  
 		int header_y_position = options.surahHeaderMarginTop;  
@@ -199,7 +209,7 @@ std::string buildAssFile(const AppConfig& config,
 	  
 		ass_file << "Dialogue: 0," << format_time_ass(header_start_time) << ","  
 				<< format_time_ass(total_video_duration)  
-				<< ",Translation,,0,0,0,,{\\an8\\pos(" << config.width/2 << "," << header_y_position << ")"  
+				<< "," << event_style << ",,0,0,0,,{\\an8\\pos(" << config.width/2 << "," << header_y_position << ")"  
 				<< "\\fs" << header_font_size  
 				<< "\\b0\\bord2\\shad1\\be1\\c&HFFFFFF&\\3c&H000000&}"  
 				//<< "\\alpha&H80&}" // Semi-transparent 
@@ -313,28 +323,32 @@ std::string buildAssFile(const AppConfig& config,
     for (const auto& dialogue : allDialogues) {
         int arabic_size = dialogue.arabicSize;
         int translation_size = dialogue.translationSize;
+        // Split layers are placed around the configured translation size, which the adaptive
+        // size never exceeds, so the burned-in Arabic stays put whichever translation rides along
+        int band_size = layers == Layers::All ? translation_size : std::max(config.translationFont.size, 10);
         double duration = dialogue.endTime - dialogue.startTime;
 
         // Scale down if needed to fit screen
         double max_total_height = config.height * 0.8;
-        double estimated_height = arabic_size * 1.2 + translation_size * 1.4;
+        double estimated_height = arabic_size * 1.2 + band_size * 1.4;
         if (estimated_height > max_total_height) {
             double scale_factor = max_total_height / estimated_height;
             arabic_size = static_cast<int>(arabic_size * scale_factor);
             translation_size = static_cast<int>(translation_size * scale_factor);
+            band_size = static_cast<int>(band_size * scale_factor);
         }
 
         double vertical_shift = config.verticalShift;
-        double total_height = arabic_size * 1.2 + translation_size * 1.4;
+        double total_height = arabic_size * 1.2 + band_size * 1.4;
         double arabic_y = config.height / 2.0 - total_height * 0.25 + vertical_shift;
         double translation_y = config.height / 2.0 + total_height * 0.25 + vertical_shift;
 
         double minArabicY = verticalPadding + arabic_size * 1.1;
-        double maxTranslationY = config.height - verticalPadding - translation_size * 1.1;
+        double maxTranslationY = config.height - verticalPadding - band_size * 1.1;
         arabic_y = std::max(arabic_y, minArabicY);
         translation_y = std::min(translation_y, maxTranslationY);
-        if (translation_y - arabic_y < translation_size * 1.2) {
-            translation_y = std::min(maxTranslationY, arabic_y + translation_size * 1.2);
+        if (translation_y - arabic_y < band_size * 1.2) {
+            translation_y = std::min(maxTranslationY, arabic_y + band_size * 1.2);
         }
 
         double fade_time = std::min(
@@ -342,28 +356,33 @@ std::string buildAssFile(const AppConfig& config,
             config.maxFadeDuration);
 
         std::stringstream combined;
-        combined << "{\\an5\\q2\\rArabic"
-                 << "\\fs" << arabic_size
-                 << "\\pos(" << config.width / 2 << "," << arabic_y << ")"
-                 << "\\fad(" << (fade_time * 1000) << "," << (fade_time * 1000) << ")";
-        if (dialogue.growEnabled) {
-            combined << "\\t(0," << duration * 1000 << ",\\fs" 
-                     << arabic_size * dialogue.arabicGrowthFactor << ")";
+        if (withArabic) {
+            combined << "{\\an5\\q2\\rArabic"
+                     << "\\fs" << arabic_size
+                     << "\\pos(" << config.width / 2 << "," << arabic_y << ")"
+                     << "\\fad(" << (fade_time * 1000) << "," << (fade_time * 1000) << ")";
+            if (dialogue.growEnabled) {
+                combined << "\\t(0," << duration * 1000 << ",\\fs" 
+                         << arabic_size * dialogue.arabicGrowthFactor << ")";
+            }
+            combined << "}" << dialogue.arabicText;
         }
-        combined << "}" << dialogue.arabicText
-                 << "\\N{\\an5\\q2\\rTranslation"
-                 << "\\fs" << translation_size
-                 << "\\pos(" << config.width / 2 << "," << translation_y << ")"
-                 << "\\fad(" << (fade_time * 1000) << "," << (fade_time * 1000) << ")";
-        if (dialogue.translationGrowthFactor > 1.0) {
-            combined << "\\t(0," << duration * 1000 << ",\\fs"
-                     << translation_size * dialogue.translationGrowthFactor << ")";
+        if (withArabic && withTranslation) combined << "\\N";
+        if (withTranslation) {
+            combined << "{\\an5\\q2\\rTranslation"
+                     << "\\fs" << translation_size
+                     << "\\pos(" << config.width / 2 << "," << translation_y << ")"
+                     << "\\fad(" << (fade_time * 1000) << "," << (fade_time * 1000) << ")";
+            if (dialogue.translationGrowthFactor > 1.0) {
+                combined << "\\t(0," << duration * 1000 << ",\\fs"
+                         << translation_size * dialogue.translationGrowthFactor << ")";
+            }
+            combined << "}" << dialogue.translationText;
         }
-        combined << "}" << dialogue.translationText;
 
         ass_file << "Dialogue: 0," << format_time_ass(dialogue.startTime) << ","
                  << format_time_ass(dialogue.endTime)
-                 << ",Translation,,0,0,0,," << combined.str() << "\n";
+                 << "," << event_style << ",,0,0,0,," << combined.str() << "\n";
     }
 
     return ass_path.string();
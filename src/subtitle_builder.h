@@ -7,6 +7,13 @@
 #include "verse_segmentation.h"
 
 namespace SubtitleBuilder {
+    // Which text a subtitle file carries; soft-subtitle renders burn Arabic and ship translations as tracks
+    enum class Layers {
+        All,
+        Arabic,       // verse text and the Arabic surah header
+        Translation   // intro card and verse translations
+    };
+
     std::string applyLatinFontFallback(const std::string& text,
                                        const std::string& fallbackFont,
                                        const std::string& primaryFont);
@@ -16,5 +23,7 @@ namespace SubtitleBuilder {
                              const std::vector<VerseData>& verses,
                              double introDuration,
                              double pauseAfterIntroDuration,
-                             const VerseSegmentation::Manager* segmentManager = nullptr);
+                             const VerseSegmentation::Manager* segmentManager = nullptr,
+                             const std::string& fileName = "subtitles.ass",
+                             Layers layers = Layers::All);
 }
@@ -0,0 +1,252 @@
+#include "text_layers.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace TextLayers {
+
+namespace {
+
+// Placeholders left in a dialogue's text where the fade and the animated sizes go
+constexpr char kFadeMark = '\x01';
+constexpr char kSizeMark = '\x02';
+
+struct Growth {
+    double from = 0.0;   // \fs at the start
+    double to = 0.0;     // \fs the \t transform grows to
+    double t1 = 0.0;     // transform window, seconds from the dialogue start
+    double t2 = 0.0;
+};
+
+struct Event {
+    std::string layer;
+    std::string fields;  // Style through Effect, as written
+    std::string text;    // with kFadeMark / kSizeMark<index> placeholders
+    double start = 0.0;
+    double end = 0.0;
+    double fadeIn = 0.0;
+    double fadeOut = 0.0;
+    std::vector<Growth> growth;
+};
+
+double parseTime(const std::string& value) {
+    int hours = 0, minutes = 0;
+    double seconds = 0.0;
+    if (std::sscanf(value.c_str(), "%d:%d:%lf", &hours, &minutes, &seconds) != 3) return -1.0;
+    return hours * 3600.0 + minutes * 60.0 + seconds;
+}
+
+std::string formatTime(int seconds) {
+    std::ostringstream out;
+    out << seconds / 3600 << ":" << std::setfill('0') << std::setw(2) << (seconds / 60) % 60 << ":"
+        << std::setw(2) << seconds % 60 << ".00";
+    return out.str();
+}
+
+// Rewrites the override blocks of one dialogue, pulling out \fad and \fs growth transforms
+void parseText(const std::string& text, Event& event) {
+    static const std::regex fadePattern(R"(\\fad\((\d+(?:\.\d+)?),(\d+(?:\.\d+)?)\))");
+    static const std::regex growPattern(R"(\\t\((\d+(?:\.\d+)?),(\d+(?:\.\d+)?),\\fs(\d+(?:\.\d+)?)\))");
+    static const std::regex sizePattern(R"(\\fs(\d+(?:\.\d+)?))");
+
+    size_t cursor = 0;
+    while (cursor < text.size()) {
+        size_t open = text.find('{', cursor);
+        size_t close = open == std::string::npos ? open : text.find('}', open);
+        if (close == std::string::npos) {
+            event.text += text.substr(cursor);
+            break;
+        }
+        event.text += text.substr(cursor, open - cursor);
+        std::string block = text.substr(open, close - open + 1);
+
+        std::smatch match;
+        if (std::regex_search(block, match, fadePattern)) {
+            event.fadeIn = std::stod(match[1]) / 1000.0;
+            event.fadeOut = std::stod(match[2]) / 1000.0;
+            block = match.prefix().str() + kFadeMark + match.suffix().str();
+        }
+        std::smatch grow;
+        if (std::regex_search(block, grow, growPattern)) {
+            Growth growth;
+            growth.t1 = std::stod(grow[1]) / 1000.0;
+            growth.t2 = std::stod(grow[2]) / 1000.0;
+            growth.to = std::stod(grow[3]);
+            block = grow.prefix().str() + grow.suffix().str();
+            std::smatch size;
+            if (std::regex_search(block, size, sizePattern)) {
+                growth.from = std::stod(size[1]);
+                block = size.prefix().str() + kSizeMark + static_cast<char>('0' + event.growth.size()) +
+                        size.suffix().str();
+                event.growth.push_back(growth);
+            }
+        }
+        event.text += block;
+        cursor = close + 1;
+    }
+}
+
+// Middle of quantization step `progress` falls into, for progress in [0, 1)
+double quantize(double progress, int steps) {
+    int step = std::clamp(static_cast<int>(std::floor(progress * steps)), 0, steps - 1);
+    return (step + 0.5) / steps;
+}
+
+// The dialogue as it looks `offset` seconds after it starts, with static tags only
+std::string renderState(const Event& event, double offset) {
+    double duration = event.end - event.start;
+    double opacity = 1.0;
+    if (event.fadeIn > 0.0 && offset < event.fadeIn) {
+        opacity = quantize(offset / event.fadeIn, kFadeSteps);
+    } else if (event.fadeOut > 0.0 && offset > duration - event.fadeOut) {
+        opacity = quantize((duration - offset) / event.fadeOut, kFadeSteps);
+    }
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    for (size_t i = 0; i < event.text.size(); ++i) {
+        char c = event.text[i];
+        if (c == kFadeMark) {
+            // \fade with a constant alpha is the same multiplier \fad applies mid-fade
+            int alpha = static_cast<int>(std::lround(255.0 * (1.0 - opacity)));
+            out << "\\fade(" << alpha << "," << alpha << "," << alpha << ",0,0,0,0)";
+        } else if (c == kSizeMark && i + 1 < event.text.size()) {
+            const Growth& growth = event.growth[event.text[++i] - '0'];
+            double progress = 1.0;
+            if (offset <= growth.t1) {
+                progress = 0.0;
+            } else if (offset < growth.t2) {
+                progress = quantize((offset - growth.t1) / (growth.t2 - growth.t1), kGrowthSteps);
+            }
+            out << "\\fs" << growth.from + (growth.to - growth.from) * progress;
+        } else {
+            out << c;
+        }
+    }
+    return event.layer + "\t" + event.fields + "\t" + out.str();
+}
+
+} // namespace
+
+Plan plan(const std::string& assPath) {
+    std::ifstream ass(assPath);
+    if (!ass.is_open()) throw std::runtime_error("Failed to read subtitles: " + assPath);
+
+    std::string header;
+    std::vector<Event> events;
+    std::string line;
+    while (std::getline(ass, line)) {
+        if (line.rfind("Dialogue:", 0) != 0) {
+            if (events.empty()) header += line + "\n";
+            continue;
+        }
+        // Dialogue: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text
+        std::vector<size_t> commas;
+        for (size_t pos = line.find(','); pos != std::string::npos && commas.size() < 9; pos = line.find(',', pos + 1)) {
+            commas.push_back(pos);
+        }
+        if (commas.size() < 9) continue;
+        Event event;
+        event.layer = line.substr(10, commas[0] - 10);
+        event.start = parseTime(line.substr(commas[0] + 1, commas[1] - commas[0] - 1));
+        event.end = parseTime(line.substr(commas[1] + 1, commas[2] - commas[1] - 1));
+        event.fields = line.substr(commas[2] + 1, commas[8] - commas[2] - 1);
+        if (event.start < 0.0 || event.end <= event.start) continue;
+        parseText(line.substr(commas[8] + 1), event);
+        events.push_back(std::move(event));
+    }
+
+    // Every instant at which some dialogue's quantized look changes
+    std::vector<double> cuts{0.0};
+    for (const auto& event : events) {
+        cuts.push_back(event.start);
+        cuts.push_back(event.end);
+        for (int k = 1; k < kFadeSteps; ++k) {
+            if (event.fadeIn > 0.0) cuts.push_back(event.start + event.fadeIn * k / kFadeSteps);
+            if (event.fadeOut > 0.0) cuts.push_back(event.end - event.fadeOut * k / kFadeSteps);
+        }
+        if (event.fadeIn > 0.0) cuts.push_back(event.start + event.fadeIn);
+        if (event.fadeOut > 0.0) cuts.push_back(event.end - event.fadeOut);
+        for (const auto& growth : event.growth) {
+            for (int k = 0; k <= kGrowthSteps; ++k) {
+                cuts.push_back(event.start + growth.t1 + (growth.t2 - growth.t1) * k / kGrowthSteps);
+            }
+        }
+    }
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end(), [](double a, double b) { return b - a < 1e-4; }),
+               cuts.end());
+
+    Plan result;
+    std::map<std::string, int> images;
+    std::ostringstream sheet;
+    sheet << header;
+    for (size_t i = 0; i + 1 < cuts.size(); ++i) {
+        double middle = (cuts[i] + cuts[i + 1]) / 2.0;
+        std::vector<std::string> lines;
+        std::string key;
+        for (const auto& event : events) {
+            if (middle < event.start || middle >= event.end) continue;
+            lines.push_back(renderState(event, middle - event.start));
+            key += lines.back() + "\n";
+        }
+
+        auto found = images.find(key);
+        int image = found != images.end() ? found->second : result.images;
+        if (found == images.end()) {
+            images[key] = image;
+            for (const auto& state : lines) {
+                size_t layerEnd = state.find('\t');
+                size_t fieldsEnd = state.find('\t', layerEnd + 1);
+                sheet << "Dialogue: " << state.substr(0, layerEnd) << "," << formatTime(image) << ","
+                      << formatTime(image + 1) << "," << state.substr(layerEnd + 1, fieldsEnd - layerEnd - 1)
+                      << "," << state.substr(fieldsEnd + 1) << "\n";
+            }
+            result.images++;
+        }
+
+        if (!result.timeline.empty() && result.timeline.back().image == image) {
+            result.timeline.back().end = cuts[i + 1];
+        } else {
+            result.timeline.push_back({cuts[i], cuts[i + 1], image});
+        }
+    }
+    result.sheet = sheet.str();
+    return result;
+}
+
+std::string imageName(int index) {
+    std::ostringstream name;
+    name << "layer_" << std::setfill('0') << std::setw(5) << index << ".png";
+    return name.str();
+}
+
+void writeConcatList(const Plan& plan, const fs::path& imagesDir, const fs::path& listPath) {
+    std::ofstream list(listPath);
+    if (!list.is_open()) throw std::runtime_error("Failed to create text layer list: " + listPath.string());
+    auto file = [&](int image) {
+        std::string escaped;
+        for (char c : fs::absolute(imagesDir / imageName(image)).generic_string()) {
+            if (c == '\'') escaped += "'\\''";
+            else escaped += c;
+        }
+        list << "file '" << escaped << "'\n";
+    };
+    list << "ffconcat version 1.0\n" << std::fixed << std::setprecision(3);
+    for (const auto& span : plan.timeline) {
+        file(span.image);
+        list << "duration " << span.end - span.start << "\n";
+    }
+    // The concat demuxer only honours the last duration when the file is listed again
+    if (!plan.timeline.empty()) file(plan.timeline.back().image);
+}
+
+} // namespace TextLayers
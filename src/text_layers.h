@@ -0,0 +1,38 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Pre-rasterized subtitles: the ASS script is cut into spans during which the text looks
+// the same (fades and growth quantized to a few steps), every distinct look is rendered
+// to one transparent image, and the images are overlaid as a timed slideshow.
+namespace TextLayers {
+
+// Steps a fade or a growth transform is quantized to
+constexpr int kFadeSteps = 5;
+constexpr int kGrowthSteps = 6;
+
+// A stretch of the render timeline showing one pre-rendered image
+struct Span {
+    double start = 0.0;
+    double end = 0.0;
+    int image = 0;
+};
+
+struct Plan {
+    std::string sheet;          // ASS script that draws image i during second i
+    int images = 0;
+    std::vector<Span> timeline; // consecutive, starting at 0
+};
+
+// Splits the subtitles into spans of constant appearance; throws when the file is unreadable
+Plan plan(const std::string& assPath);
+
+// layer_00000.png, ... as written by ffmpeg with -start_number 0
+std::string imageName(int index);
+
+// ffconcat slideshow of the rendered images following the plan's timeline
+void writeConcatList(const Plan& plan, const std::filesystem::path& imagesDir,
+                     const std::filesystem::path& listPath);
+
+} // namespace TextLayers
@@ -0,0 +1,109 @@
+#include "thread_policy.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace ThreadPolicy {
+
+namespace {
+
+// libass and overlay do most of their work on one thread; slice threads beyond a
+// few only take cores from the encoder
+constexpr int kMaxFilterThreads = 4;
+constexpr int kCoresPerFilterThread = 4;
+
+int quotaToCores(long long quota, long long period) {
+    if (quota <= 0 || period <= 0) return 0;
+    return static_cast<int>(std::ceil(static_cast<double>(quota) / static_cast<double>(period)));
+}
+
+} // namespace
+
+int quotaCores(const fs::path& root) {
+    // cgroup v2: "<quota> <period>" or "max <period>"
+    std::ifstream v2(root / "cpu.max");
+    if (v2.is_open()) {
+        std::string quota;
+        long long period = 0;
+        v2 >> quota >> period;
+        if (quota == "max") return 0;
+        try {
+            return quotaToCores(std::stoll(quota), period);
+        } catch (const std::exception&) {
+            return 0;
+        }
+    }
+    // cgroup v1: quota is -1 when unlimited
+    for (const char* controller : {"cpu", "cpu,cpuacct"}) {
+        std::ifstream quotaFile(root / controller / "cpu.cfs_quota_us");
+        std::ifstream periodFile(root / controller / "cpu.cfs_period_us");
+        long long quota = 0, period = 0;
+        if (quotaFile >> quota && periodFile >> period) return quotaToCores(quota, period);
+    }
+    return 0;
+}
+
+int availableCores() {
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+#if defined(__linux__)
+    // hardware_concurrency counts online CPUs, not the ones taskset/cpuset leave us
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        cores = std::min(cores, std::max(1, CPU_COUNT(&mask)));
+    }
+#endif
+    int quota = quotaCores();
+    if (quota > 0) cores = std::min(cores, quota);
+    return cores;
+}
+
+Allocation allocate(int threads, int jobs) {
+    Allocation allocation;
+    allocation.cores = threads > 0 ? threads : availableCores();
+    allocation.jobs = std::max(1, jobs);
+    int share = std::max(1, allocation.cores / allocation.jobs);
+    allocation.filterThreads = std::clamp(share / kCoresPerFilterThread, 1, kMaxFilterThreads);
+    allocation.encoderThreads = std::max(1, share - allocation.filterThreads);
+    return allocation;
+}
+
+Allocation resolve(const AppConfig& config) {
+    return allocate(config.threads, config.jobs);
+}
+
+int threadsPerEncoder(const Allocation& allocation, int encoders) {
+    return std::max(1, allocation.encoderThreads / std::max(1, encoders));
+}
+
+int lookaheadThreads(int threads) {
+    return std::max(1, threads / 6);
+}
+
+std::string encoderArgs(const Allocation& allocation, int encoders, bool x264) {
+    int threads = threadsPerEncoder(allocation, encoders);
+    std::ostringstream args;
+    args << "-threads " << threads << " ";
+    if (x264) args << "-x264-params lookahead-threads=" << lookaheadThreads(threads) << " ";
+    return args.str();
+}
+
+json toJson(const Allocation& allocation) {
+    return {
+        {"cores", allocation.cores},
+        {"jobs", allocation.jobs},
+        {"filterThreads", allocation.filterThreads},
+        {"encoderThreads", allocation.encoderThreads},
+        {"lookaheadThreads", lookaheadThreads(allocation.encoderThreads)}
+    };
+}
+
+} // namespace ThreadPolicy
@@ -0,0 +1,43 @@
+#pragma once
+#include "types.h"
+#include <filesystem>
+#include <string>
+#include <nlohmann/json.hpp>
+
+// How a render spends the host's CPUs: a share of the usable cores per concurrent
+// render, split between the filter graph and the encoder(s) of that render.
+namespace ThreadPolicy {
+
+struct Allocation {
+    int cores = 1;             // usable cores (affinity and cgroup quota applied) or the --threads budget
+    int jobs = 1;              // renders sharing those cores
+    int filterThreads = 1;     // -filter_complex_threads per render
+    int encoderThreads = 1;    // encoder threads per render, split across its outputs
+};
+
+// CPU quota of the cgroup rooted at `root` in whole cores (rounded up), or 0 when
+// unlimited or unreadable. Reads cgroup v2 cpu.max, then v1 cpu.cfs_quota_us.
+int quotaCores(const std::filesystem::path& root = "/sys/fs/cgroup");
+
+// Cores this process may run on: hardware threads, CPU affinity and cgroup quota
+int availableCores();
+
+// Splits `threads` (0 = availableCores()) between `jobs` renders
+Allocation allocate(int threads, int jobs);
+
+// AppConfig::threads / AppConfig::jobs with the usable cores of this host
+Allocation resolve(const AppConfig& config);
+
+// Threads for each of `encoders` encoders running in one ffmpeg process
+int threadsPerEncoder(const Allocation& allocation, int encoders);
+
+// x264 lookahead threads for an encoder with `threads` threads (x264's own 1:6 ratio)
+int lookaheadThreads(int threads);
+
+// Output options for one of `encoders` encoders ("-threads N", plus lookahead for x264)
+std::string encoderArgs(const Allocation& allocation, int encoders, bool x264);
+
+// Recorded in the render metadata
+nlohmann::json toJson(const Allocation& allocation);
+
+} // namespace ThreadPolicy
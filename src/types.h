@@ -91,6 +91,10 @@ struct AppConfig {
     std::string videoMaxRate;
     std::string videoBufSize;
 
+    // Thread policy (see ThreadPolicy::allocate)
+    int threads;                    // total threads for renders on this host (0 = usable cores)
+    int jobs;                       // renders sharing those threads
+
     // R2 dynamic video selection configuration
     VideoSelectionConfig videoSelection;
 };
@@ -122,6 +126,14 @@ struct VerseData {
     std::string sourceAudioPath;
 };
 
+// An extra output encoded from the same decode as the main render
+struct RenderVariant {
+    int width = 0;           // 0 keeps the main output size
+    int height = 0;
+    int crf = -1;            // -1 keeps the config CRF
+    int translationId = -1;  // -1 keeps the main translation
+};
+
 struct CLIOptions {
     int surah;
     int from;
@@ -139,10 +151,22 @@ struct CLIOptions {
     std::string translationFontColor = "";
     bool noCache = false;
     bool clearCache = false;
+    std::string renderStorePath = "";  // shared store for finished renders (default: cache/renders)
+    std::vector<RenderVariant> variants;  // --renditions and --translations, written next to the main output
+    bool softSubtitles = false;  // burn Arabic only; translations become subtitle tracks
+    std::string container = "mp4";  // mp4 (faststart), fmp4 (fragmented, progressive) or hls
+    int loopMemoryMb = 1024;        // budget for holding the decoded static background loop (0 = stream_loop)
+    bool staticBackground = false;  // treat the background as a still (first frame) and write VFR
+    bool prerenderText = false;     // rasterize each subtitle look once and overlay it instead of libass per frame
+    double deadlineSeconds = 0.0;   // --deadline: choose the x264 preset from the render history (0 = off)
+    bool draft = false;             // low-resolution ultrafast preview (see VideoGenerator::draftConfig)
+    std::string uploadKey = "";     // --upload-r2: stream the finished video to this object key
+    std::string uploadBucket = "";  // bucket for --upload-r2 (default: the background bucket)
     std::string preset = "fast";
     std::string encoder = "software";
     std::string recitationMode = "";  // "gapped" or "gapless"
     bool presetProvided = false;
+    bool encoderProvided = false;
     bool emitProgress = false;
 	bool showSurahHeader = false;
 	int surahHeaderFontSize = 50;  
@@ -164,6 +188,8 @@ struct CLIOptions {
     std::string videoBitrateOverride = "";
     std::string videoMaxRateOverride = "";
     std::string videoBufSizeOverride = "";
+    int threadsOverride = -1;
+    int jobsOverride = -1;
 
     // R2 dynamic video selection configuration
     VideoSelectionConfig videoSelection;
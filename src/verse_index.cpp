@@ -0,0 +1,131 @@
+#include "verse_index.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace VerseIndex {
+
+namespace {
+
+constexpr int kIndexVersion = 1;
+
+int verseNumber(const std::string& verseKey) {
+    size_t colon = verseKey.find(':');
+    if (colon == std::string::npos) return -1;
+    try {
+        return std::stoi(verseKey.substr(colon + 1));
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+} // namespace
+
+json Index::toJson() const {
+    json entries = json::array();
+    for (const auto& entry : verses) {
+        entries.push_back({{"verseKey", entry.verseKey}, {"start", entry.start}, {"end", entry.end}});
+    }
+    return {{"version", kIndexVersion}, {"surah", surah}, {"verses", entries}};
+}
+
+Index Index::fromJson(const json& data) {
+    Index index;
+    index.surah = data.value("surah", 0);
+    if (!data.contains("verses") || !data["verses"].is_array()) return index;
+    for (const auto& item : data["verses"]) {
+        Entry entry;
+        entry.verseKey = item.value("verseKey", "");
+        entry.start = item.value("start", 0.0);
+        entry.end = item.value("end", 0.0);
+        if (!entry.verseKey.empty()) index.verses.push_back(entry);
+    }
+    return index;
+}
+
+Index build(const CLIOptions& options, const AppConfig& config, const std::vector<VerseData>& verses) {
+    Index index;
+    index.surah = options.surah;
+    double cursor = config.introDuration + config.pauseAfterIntroDuration;
+    for (const auto& verse : verses) {
+        index.verses.push_back({verse.verseKey, cursor, cursor + verse.durationInSeconds});
+        cursor += verse.durationInSeconds;
+    }
+    return index;
+}
+
+fs::path sidecarPath(const fs::path& video) {
+    fs::path path = video;
+    path.replace_extension(".verses.json");
+    return path;
+}
+
+void write(const Index& index, const fs::path& video) {
+    fs::path path = sidecarPath(video);
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to write verse index: " + path.string());
+    }
+    file << index.toJson().dump(2) << '\n';
+}
+
+Index load(const fs::path& video) {
+    fs::path path = sidecarPath(video);
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("No verse index next to " + video.string() + " (expected " + path.string() + ")");
+    }
+    return Index::fromJson(json::parse(file));
+}
+
+fs::path extract(const fs::path& video,
+                 int from,
+                 int to,
+                 const fs::path& output,
+                 std::shared_ptr<Interfaces::IProcessExecutor> processExecutor) {
+    Index index = load(video);
+    if (from > to) throw std::invalid_argument("Invalid verse range");
+
+    // The Bismillah ("1:1" outside Al-Fatiha) is not part of any requested range
+    const Entry* first = nullptr;
+    const Entry* last = nullptr;
+    for (const auto& entry : index.verses) {
+        if (index.surah != 1 && entry.verseKey == "1:1") continue;
+        int number = verseNumber(entry.verseKey);
+        if (number == from && !first) first = &entry;
+        if (number == to) last = &entry;
+    }
+    if (!first || !last) {
+        throw std::runtime_error("Render does not contain verses " + std::to_string(from) + "-" + std::to_string(to));
+    }
+
+    fs::path target = output;
+    if (target.empty()) {
+        target = video;
+        target.replace_filename(video.stem().string() + "_" + std::to_string(from) + "-" + std::to_string(to) +
+                                video.extension().string());
+    }
+
+    // Verse starts are keyframes, so an input seek lands exactly on the cut
+    std::ostringstream cmd;
+    cmd << std::fixed << std::setprecision(3);
+    cmd << "ffmpeg -y -ss " << first->start << " -i \"" << video.generic_string() << "\" "
+        << "-t " << (last->end - first->start) << " "
+        << "-map 0 -c copy -avoid_negative_ts make_zero ";
+    if (target.extension() == ".mp4") cmd << "-movflags +faststart ";
+    cmd << "\"" << target.generic_string() << "\"";
+
+    std::cout << "Extracting verses " << from << "-" << to << ":\n" << cmd.str() << std::endl;
+    if (processExecutor->execute(cmd.str()) != 0) {
+        throw std::runtime_error("FFmpeg extraction failed");
+    }
+    std::cout << "✅ Extracted to: " << target << std::endl;
+    return target;
+}
+
+} // namespace VerseIndex
@@ -0,0 +1,43 @@
+#pragma once
+#include "types.h"
+#include "interfaces/IProcessExecutor.h"
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace VerseIndex {
+
+// Where one verse sits on the rendered video's timeline
+struct Entry {
+    std::string verseKey;
+    double start = 0.0;
+    double end = 0.0;
+};
+
+struct Index {
+    int surah = 0;
+    std::vector<Entry> verses;
+
+    nlohmann::json toJson() const;
+    static Index fromJson(const nlohmann::json& data);
+};
+
+// Verse timings as laid out by the subtitle builder (after the intro and pause)
+Index build(const CLIOptions& options, const AppConfig& config, const std::vector<VerseData>& verses);
+
+// Sidecar next to a render: <video>.verses.json
+std::filesystem::path sidecarPath(const std::filesystem::path& video);
+void write(const Index& index, const std::filesystem::path& video);
+Index load(const std::filesystem::path& video);
+
+// Stream-copies verses from..to of a render made with verse keyframes; throws on a missing
+// index or a range the render does not cover. Returns the extracted file's path.
+std::filesystem::path extract(const std::filesystem::path& video,
+                              int from,
+                              int to,
+                              const std::filesystem::path& output,
+                              std::shared_ptr<Interfaces::IProcessExecutor> processExecutor);
+
+} // namespace VerseIndex
@@ -4,8 +4,12 @@
 #include "quran_data.h"
 #include "audio/custom_audio_processor.h"
 #include "interfaces/IProcessExecutor.h"
+#include "cache_utils.h"
+#include "render_cache.h"
 #include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
 #include <sstream>
@@ -15,16 +19,25 @@
 #include <fstream>
 #include <iomanip>
 #include <limits>
+#include <optional>
 #include <algorithm>
 #include <cctype>
+#include <regex>
 #include "subtitle_builder.h"
 #include "localization_utils.h"
+#include "config_loader.h"
+#include "verse_index.h"
+#include "text_layers.h"
+#include "thread_policy.h"
+#include "encoder_backends.h"
+#include "render_history.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
 }
 
 namespace fs = std::filesystem;
+using json = nlohmann::json;
 
 namespace {
     void emitProgressEvent(const std::string& stage,
@@ -50,6 +63,242 @@ void emitStageMessage(const std::string& stage,
                       const std::string& message) {
     emitProgressEvent(stage, status, -1.0, -1.0, -1.0, message);
 }
+
+// Openings shorter than this are not worth an extra segment boundary
+constexpr double kMinOpeningSeconds = 1.0;
+
+// Bump when the opening encode changes for identical inputs
+constexpr int kOpeningCacheVersion = 1;
+
+// Intro card, pause and a leading Bismillah: the part of the video that repeats across renders
+double openingDuration(const CLIOptions& options, const AppConfig& config, const std::vector<VerseData>& verses) {
+    double end = config.introDuration + config.pauseAfterIntroDuration;
+    if (!verses.empty() && verses.front().verseKey == "1:1" && options.surah != 1) {
+        end += verses.front().durationInSeconds;
+    }
+    return end;
+}
+
+// "H:MM:SS.cc" as written by the subtitle builder
+double parseAssTime(const std::string& value) {
+    int hours = 0, minutes = 0;
+    double seconds = 0.0;
+    if (std::sscanf(value.c_str(), "%d:%d:%lf", &hours, &minutes, &seconds) != 3) return -1.0;
+    return hours * 3600.0 + minutes * 60.0 + seconds;
+}
+
+// Draft previews trade detail for speed; text stays legible at this size
+constexpr int kDraftShortSide = 360;
+constexpr int kDraftMaxFps = 15;
+
+// A verse-key still is taken this far into the verse (at most half of it), past the fade-in
+constexpr double kStillVerseOffsetSeconds = 1.0;
+
+// Bump when the text layer rendering changes for identical subtitles
+constexpr int kTextLayerCacheVersion = 1;
+
+// Between subtitle changes a still background gets one frame per this many seconds
+constexpr double kStillHoldSeconds = 1.0;
+
+bool isStillImage(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" ||
+           extension == ".webp" || extension == ".bmp";
+}
+
+// select expression for a still background: every frame while a subtitle fades or grows,
+// the frame after it appears or disappears, and one hold frame per kStillHoldSeconds
+std::string changeSelectExpr(const std::string& assPath, int fps) {
+    static const std::regex fadePattern(R"(\\fad\((\d+(?:\.\d+)?),(\d+(?:\.\d+)?)\))");
+    double frame = 1.0 / fps;
+    std::vector<std::pair<double, double>> windows;
+    std::ifstream ass(assPath);
+    std::string line;
+    while (std::getline(ass, line)) {
+        if (line.rfind("Dialogue:", 0) != 0) continue;
+        size_t startField = line.find(',');
+        size_t endField = startField == std::string::npos ? startField : line.find(',', startField + 1);
+        size_t textField = endField == std::string::npos ? endField : line.find(',', endField + 1);
+        if (textField == std::string::npos) continue;
+        double start = parseAssTime(line.substr(startField + 1, endField - startField - 1));
+        double end = parseAssTime(line.substr(endField + 1, textField - endField - 1));
+        if (start < 0.0 || end < start) continue;
+        if (line.find("\\t(") != std::string::npos) {
+            windows.emplace_back(start, end + frame);
+            continue;
+        }
+        double fadeIn = 0.0, fadeOut = 0.0;
+        std::smatch match;
+        if (std::regex_search(line, match, fadePattern)) {
+            fadeIn = std::stod(match[1]) / 1000.0;
+            fadeOut = std::stod(match[2]) / 1000.0;
+        }
+        windows.emplace_back(start, start + fadeIn + frame);
+        windows.emplace_back(std::max(start, end - fadeOut), end + frame);
+    }
+    std::sort(windows.begin(), windows.end());
+    std::vector<std::pair<double, double>> merged;
+    for (const auto& window : windows) {
+        if (!merged.empty() && window.first <= merged.back().second) {
+            merged.back().second = std::max(merged.back().second, window.second);
+        } else {
+            merged.push_back(window);
+        }
+    }
+
+    std::ostringstream expr;
+    expr << std::fixed << std::setprecision(3);
+    expr << "not(mod(n," << std::max(1, static_cast<int>(std::lround(fps * kStillHoldSeconds))) << "))";
+    for (const auto& window : merged) {
+        expr << "+between(t," << window.first << "," << window.second << ")";
+    }
+    return expr.str();
+}
+
+// Bump when the soft-subtitle picture encode changes for identical inputs
+constexpr int kPictureCacheVersion = 1;
+
+bool isMatroska(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".mkv";
+}
+
+// Muxer arguments for --container. Fragmented outputs are playable while they are
+// being written and skip the faststart rewrite of the finished file.
+std::string containerArgs(const std::string& container, const fs::path& target) {
+    if (isMatroska(target)) return "";
+    if (container == "fmp4") return "-movflags +frag_keyframe+empty_moov+default_base_moof ";
+    if (container == "hls") return "-f hls -hls_time 6 -hls_playlist_type vod -hls_segment_type fmp4 ";
+    return "-movflags +faststart ";
+}
+
+// HLS writes a directory named after the output, with the playlist and segments inside
+fs::path containerTarget(const std::string& container, const fs::path& path) {
+    if (container != "hls") return path;
+    fs::path directory = path;
+    directory.replace_extension("");
+    fs::create_directories(directory);
+    return directory / "index.m3u8";
+}
+
+// Moves a finished output into place and returns the path of its playable file
+fs::path moveOutput(const fs::path& from, const fs::path& to, const std::string& container) {
+    if (container != "hls") {
+        fs::rename(from, to);
+        return to;
+    }
+    fs::path fromDirectory = from;
+    fromDirectory.replace_extension("");
+    fs::path toDirectory = to;
+    toDirectory.replace_extension("");
+    fs::remove_all(toDirectory);
+    fs::rename(fromDirectory, toDirectory);
+    return toDirectory / "index.m3u8";
+}
+
+// Bump when the audio track encode changes for identical inputs
+constexpr int kAudioTrackCacheVersion = 1;
+
+// Media inputs are identified by path, size and mtime instead of contents
+json statFile(const std::string& path) {
+    json info = {{"path", path}};
+    std::error_code ec;
+    if (path.empty() || !fs::exists(path, ec)) return info;
+    info["size"] = fs::file_size(path, ec);
+    info["modified"] = static_cast<long long>(fs::last_write_time(path, ec).time_since_epoch().count());
+    return info;
+}
+
+// Every verse and segment start, so ranges can later be cut by stream copy
+std::vector<double> keyframeTimes(const VerseIndex::Index& index, const std::string& assPath) {
+    std::vector<double> times;
+    for (const auto& entry : index.verses) times.push_back(entry.start);
+    std::ifstream ass(assPath);
+    std::string line;
+    while (std::getline(ass, line)) {
+        if (line.rfind("Dialogue:", 0) != 0) continue;
+        size_t startField = line.find(',');
+        size_t endField = startField == std::string::npos ? startField : line.find(',', startField + 1);
+        if (endField == std::string::npos) continue;
+        double start = parseAssTime(line.substr(startField + 1, endField - startField - 1));
+        if (start > 0.0) times.push_back(start);
+    }
+    std::sort(times.begin(), times.end());
+    times.erase(std::unique(times.begin(), times.end(),
+                            [](double a, double b) { return std::abs(a - b) < 0.01; }),
+                times.end());
+    return times;
+}
+
+// -force_key_frames for the boundaries inside [from, to), relative to from
+std::string keyframeArgs(const std::vector<double>& times, double from, double to) {
+    std::ostringstream list;
+    list << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (double time : times) {
+        if (time <= from + 0.001 || time >= to) continue;
+        list << (first ? "" : ",") << (time - from);
+        first = false;
+    }
+    if (first) return "";
+    return "-force_key_frames \"" + list.str() + "\" ";
+}
+
+// The index is a convenience for --extract; failing to write it does not fail the render
+void writeVerseIndex(const VerseIndex::Index& index, const fs::path& video) {
+    try {
+        VerseIndex::write(index, video);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: " << e.what() << std::endl;
+    }
+}
+
+// Background clips are identified by size and mtime; a concat list by its contents
+json describeInputs(const std::string& inputArgs,
+                    const std::vector<std::string>& inputFiles,
+                    bool usesConcatList,
+                    const AppConfig& config) {
+    json files = json::array();
+    std::vector<std::string> paths = inputFiles;
+    if (paths.empty()) paths.push_back(config.assetBgVideo);
+    for (const auto& path : paths) {
+        files.push_back(usesConcatList ? json{{"list", CacheUtils::hashFile(path)}} : statFile(path));
+    }
+    return {{"args", usesConcatList ? "concat" : inputArgs}, {"files", files}};
+}
+
+// Keyed on the subtitle styles and every event that starts inside the opening,
+// so range text, language, resolution and fade settings all select their own segment
+fs::path openingCachePath(const std::string& assPath, double openingEnd, const json& inputs) {
+    std::ifstream ass(assPath);
+    if (!ass.is_open()) throw std::runtime_error("Failed to read subtitles: " + assPath);
+    std::string script;
+    std::string line;
+    bool inEvents = false;
+    while (std::getline(ass, line)) {
+        if (line.rfind("[Events]", 0) == 0) inEvents = true;
+        if (inEvents && line.rfind("Dialogue:", 0) == 0) {
+            size_t startField = line.find(',');
+            size_t endField = startField == std::string::npos ? startField : line.find(',', startField + 1);
+            if (endField == std::string::npos) continue;
+            double start = parseAssTime(line.substr(startField + 1, endField - startField - 1));
+            if (start < 0.0 || start >= openingEnd) continue;
+        }
+        script += line + "\n";
+    }
+
+    json key = {
+        {"version", kOpeningCacheVersion},
+        {"end", openingEnd},
+        {"subtitles", script},
+        {"inputs", inputs}
+    };
+    return CacheUtils::getCacheRoot() / "openings" / (CacheUtils::hashString(key.dump()) + ".mp4");
+}
 }
 
 // Normalize paths for ffmpeg arguments.
@@ -78,11 +327,100 @@ static std::string to_ffmpeg_filter_path(const fs::path& p) {
 #endif
 }
 
-void VideoGenerator::generateVideo(const CLIOptions& options, 
+fs::path VideoGenerator::finalOutputPath(const CLIOptions& options) {
+    std::string englishName = QuranData::surahNames.at(options.surah);
+    std::string arabicName = LocalizationUtils::getLocalizedSurahName(options.surah, "ar");
+    std::string filename = "Surah - " + std::to_string(options.surah) + "_" + std::to_string(options.from) + "_" + std::to_string(options.to) + " - " + englishName + " - " + arabicName + " - t" + std::to_string(options.translationId) + "_r" + std::to_string(options.reciterId) + (options.draft ? " - draft" : "") + ".mp4";
+    return fs::path("out") / fs::u8path(filename);
+}
+
+AppConfig VideoGenerator::draftConfig(const AppConfig& config) {
+    AppConfig draft = config;
+    double scale = std::min(1.0, static_cast<double>(kDraftShortSide) / std::min(config.width, config.height));
+    // libx264 with yuv420p needs even dimensions
+    draft.width = static_cast<int>(std::lround(config.width * scale / 2.0)) * 2;
+    draft.height = static_cast<int>(std::lround(config.height * scale / 2.0)) * 2;
+    draft.fps = std::min(config.fps, kDraftMaxFps);
+    return draft;
+}
+
+int VideoGenerator::loopBufferFrames(double clipSeconds, const AppConfig& picture, int budgetMb) {
+    if (clipSeconds <= 0.0 || budgetMb <= 0) return 0;
+    // Frames are held as 4:2:0, 8 or 16 bits per sample
+    double bytesPerPixel = picture.pixelFormat.find("10") != std::string::npos ? 3.0 : 1.5;
+    double frameBytes = static_cast<double>(picture.width) * picture.height * bytesPerPixel;
+    int frames = static_cast<int>(std::ceil(clipSeconds * picture.fps));
+    if (frames * frameBytes > budgetMb * 1024.0 * 1024.0) return 0;
+    return frames;
+}
+
+std::vector<RenderVariant> VideoGenerator::parseRenditions(const std::string& spec) {
+    static const std::regex entryPattern(R"(\s*(\d+)x(\d+)(?::(\d+))?\s*)");
+    std::vector<RenderVariant> variants;
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::smatch match;
+        if (!std::regex_match(item, match, entryPattern)) {
+            throw std::invalid_argument("Invalid rendition '" + item + "' (expected WIDTHxHEIGHT[:CRF])");
+        }
+        RenderVariant variant;
+        variant.width = std::stoi(match[1]);
+        variant.height = std::stoi(match[2]);
+        if (match[3].matched) variant.crf = std::stoi(match[3]);
+        // libx264 with yuv420p needs even dimensions
+        if (variant.width <= 0 || variant.height <= 0 || variant.width % 2 != 0 || variant.height % 2 != 0 ||
+            variant.crf > 51) {
+            throw std::invalid_argument("Invalid rendition '" + item + "'");
+        }
+        variants.push_back(variant);
+    }
+    if (variants.empty()) {
+        throw std::invalid_argument("No renditions given");
+    }
+    return variants;
+}
+
+std::vector<RenderVariant> VideoGenerator::parseTranslations(const std::string& spec) {
+    static const std::regex idPattern(R"(\s*(\d+)\s*)");
+    std::vector<RenderVariant> variants;
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        std::smatch match;
+        if (!std::regex_match(item, match, idPattern)) {
+            throw std::invalid_argument("Invalid translation ID '" + item + "'");
+        }
+        RenderVariant variant;
+        variant.translationId = std::stoi(match[1]);
+        bool duplicate = std::any_of(variants.begin(), variants.end(), [&](const RenderVariant& existing) {
+            return existing.translationId == variant.translationId;
+        });
+        if (!duplicate) variants.push_back(variant);
+    }
+    if (variants.empty()) {
+        throw std::invalid_argument("No translations given");
+    }
+    return variants;
+}
+
+fs::path VideoGenerator::variantOutputPath(const fs::path& base, const RenderVariant& variant) {
+    std::string suffix;
+    if (variant.width > 0) suffix += "_" + std::to_string(variant.width) + "x" + std::to_string(variant.height);
+    if (variant.crf >= 0) suffix += "_crf" + std::to_string(variant.crf);
+    if (variant.translationId >= 0) suffix += "_t" + std::to_string(variant.translationId);
+    fs::path path = base;
+    path.replace_filename(fs::u8path(base.stem().u8string() + suffix + base.extension().u8string()));
+    return path;
+}
+
+std::string VideoGenerator::generateVideo(const CLIOptions& options, 
                                    const AppConfig& config, 
                                    const std::vector<VerseData>& verses, 
                                    std::shared_ptr<Interfaces::IProcessExecutor> processExecutor,
-                                   const VerseSegmentation::Manager* segmentManager) {
+                                   const VerseSegmentation::Manager* segmentManager,
+                                   std::shared_ptr<Interfaces::IStreamUploader> uploader,
+                                   EncodeStats* stats) {
     try {
         std::cout << "\n=== Starting Video Rendering ===" << std::endl;
         
@@ -103,8 +441,17 @@ void VideoGenerator::generateVideo(const CLIOptions& options,
         }
         double total_duration = intro_duration + pause_after_intro_duration + verses_duration;
         
-        // Get background video segments without pre-stitching
-        BackgroundVideo::Manager bgManager(config, options);
+        // Drafts decode and encode at preview size; the subtitles below keep the full-size
+        // layout (PlayResX/Y) and libass scales them onto the smaller frame
+        AppConfig picture_config = options.draft ? draftConfig(config) : config;
+        if (options.draft) {
+            std::cout << "Draft preview: " << picture_config.width << "x" << picture_config.height
+                      << " @ " << picture_config.fps << "fps" << std::endl;
+        }
+
+        // Get background video segments without pre-stitching; drafts use standardized
+        // renditions at the preview size when the manifest has them
+        BackgroundVideo::Manager bgManager(picture_config, options);
         std::vector<std::string> bgInputFiles;
         std::string bgFilterComplex;
         
@@ -121,65 +468,145 @@ void VideoGenerator::generateVideo(const CLIOptions& options,
 
         std::cout << "Generating subtitles..." << std::endl;
         if (options.emitProgress) emitStageMessage("subtitles", "running", "Generating subtitles");
-        std::string ass_filename = SubtitleBuilder::buildAssFile(config, options, verses, intro_duration, pause_after_intro_duration, segmentManager);
+        // Soft-subtitle renders burn only the Arabic layer; translations are muxed as tracks
+        SubtitleBuilder::Layers burned_layers = options.softSubtitles ? SubtitleBuilder::Layers::Arabic
+                                                                      : SubtitleBuilder::Layers::All;
+        std::string ass_filename = SubtitleBuilder::buildAssFile(config, options, verses, intro_duration, pause_after_intro_duration,
+                                                                 segmentManager, "subtitles.ass", burned_layers);
         std::string ass_ffmpeg_path = to_ffmpeg_filter_path(fs::path(ass_filename));
         std::string fonts_ffmpeg_path = to_ffmpeg_filter_path(fs::absolute(config.assetFolderPath) / "fonts");
         if (options.emitProgress) emitStageMessage("subtitles", "completed", "Subtitles generated");
 
-        size_t at_pos = config.overlayColor.find('@');
-        bool apply_overlay = true;
-        if (at_pos != std::string::npos) {
-            try {
-                double alpha = std::stod(config.overlayColor.substr(at_pos + 1));
-                if (alpha <= 0.0) apply_overlay = false;
-            } catch(...) {}
-        }
+        // A still background only changes with the subtitles, so frames are encoded only
+        // around subtitle changes and the output is variable frame rate
+        bool still_background = bgInputFiles.empty() &&
+                                (options.staticBackground || isStillImage(config.assetBgVideo));
+
+        // Dynamic backgrounds dim per segment and skip clips standardized pre-dimmed
+        bool apply_overlay = BackgroundVideo::overlayVisible(config.overlayColor) && !bgManager.overlayApplied();
 
-        std::ostringstream video_codec;
-        if (options.encoder == "hardware") {
-            #if defined(__APPLE__)
-                video_codec << "-c:v h264_videotoolbox ";
-                const std::string hardwareBitrate = !config.videoBitrate.empty() ? config.videoBitrate : "3500k";
-                video_codec << "-b:v " << hardwareBitrate << " ";
-                if (!config.videoMaxRate.empty()) video_codec << "-maxrate " << config.videoMaxRate << " ";
-                if (!config.videoBufSize.empty()) video_codec << "-bufsize " << config.videoBufSize << " ";
-                video_codec << "-allow_sw 1";
-                std::cout << "Using hardware encoder: h264_videotoolbox" << std::endl;
-            #else
-                video_codec << "-c:v libx264 -preset " << options.preset << " -crf " << config.crf << " ";
-                if (!config.videoBitrate.empty()) video_codec << "-b:v " << config.videoBitrate << " ";
-                if (!config.videoMaxRate.empty()) video_codec << "-maxrate " << config.videoMaxRate << " ";
-                if (!config.videoBufSize.empty()) video_codec << "-bufsize " << config.videoBufSize << " ";
-            #endif
+        const ThreadPolicy::Allocation threads = ThreadPolicy::resolve(config);
+        const std::string filter_threads = "-filter_complex_threads " + std::to_string(threads.filterThreads) + " ";
+        const std::string codec = EncoderBackends::codecName(options.encoder);
+        // One of `encoders` outputs of the same ffmpeg process, which share its encoder threads
+        auto codec_args = [&](int crf, int encoders) {
+            EncoderBackends::RateControl rate{crf, config.videoBitrate, config.videoMaxRate, config.videoBufSize};
+            std::string args = EncoderBackends::videoArgs(options.encoder, options.preset, rate, threads, encoders);
+            if (still_background) args += "-fps_mode vfr ";
+            return args;
+        };
+        if (codec == "h264_videotoolbox") {
+            std::cout << "Using hardware encoder: h264_videotoolbox" << std::endl;
         } else {
-            video_codec << "-c:v libx264 -preset " << options.preset << " -crf " << config.crf << " ";
-            if (!config.videoBitrate.empty()) video_codec << "-b:v " << config.videoBitrate << " ";
-            if (!config.videoMaxRate.empty()) video_codec << "-maxrate " << config.videoMaxRate << " ";
-            if (!config.videoBufSize.empty()) video_codec << "-bufsize " << config.videoBufSize << " ";
-            std::cout << "Using software encoder: libx264 ('" << options.preset << "')" << std::endl;
+            std::cout << "Using software encoder: " << codec << " ('" << options.preset << "')" << std::endl;
         }
+        std::string video_codec = codec_args(config.crf, 1);
+        std::cout << "Threads: " << threads.encoderThreads << " encoder + " << threads.filterThreads
+                  << " filter (" << threads.cores << " cores / " << threads.jobs << " jobs)" << std::endl;
 
-        // Build ffmpeg command with all inputs
-        std::stringstream final_cmd;
-        final_cmd << "ffmpeg ";
-        if (options.emitProgress) {
-            final_cmd << "-progress pipe:1 -nostats -loglevel warning ";
-        }
-        final_cmd << "-y ";
-        
-        // Add background video inputs
+        // Background inputs and the video chain are shared by every encode below
+        std::ostringstream bg_inputs;
+        std::string bg_chain;
         if (!bgInputFiles.empty()) {
             // Dynamic backgrounds - add all video files as inputs
+            if (bgManager.usesConcatList()) {
+                bg_inputs << "-f concat -safe 0 ";
+            }
             for (const auto& bgFile : bgInputFiles) {
-                final_cmd << "-i \"" << to_ffmpeg_path(bgFile) << "\" ";
+                bg_inputs << "-i \"" << to_ffmpeg_path(bgFile) << "\" ";
             }
+            bg_chain = bgFilterComplex;
+        } else if (still_background) {
+            // Decode one frame and repeat it; frames are selected before scaling, overlay and
+            // subtitles so the dropped ones cost nothing but a reference
+            bg_inputs << "-i \"" << to_ffmpeg_path(config.assetBgVideo) << "\" ";
+            bg_chain = "[0:v]trim=end_frame=1,loop=loop=-1:size=1:start=0,setpts=N/(" +
+                       std::to_string(picture_config.fps) + "*TB),select='" +
+                       changeSelectExpr(ass_filename, picture_config.fps) + "',scale=" +
+                       std::to_string(picture_config.width) + ":" + std::to_string(picture_config.height);
         } else {
-            // Static background with loop
-            final_cmd << "-stream_loop -1 -i \"" << to_ffmpeg_path(config.assetBgVideo) << "\" ";
+            std::string size = std::to_string(picture_config.width) + ":" + std::to_string(picture_config.height);
+            std::string fps = std::to_string(picture_config.fps);
+            int loop_frames = loopBufferFrames(Audio::CustomAudioProcessor::probeDuration(config.assetBgVideo),
+                                               picture_config, options.loopMemoryMb);
+            if (loop_frames > 0) {
+                // Decode and scale the loop once; the loop filter replays the scaled frames
+                // from memory, so decode cost no longer grows with the video length
+                bg_inputs << "-i \"" << to_ffmpeg_path(config.assetBgVideo) << "\" ";
+                bg_chain = "[0:v]setpts=PTS-STARTPTS,scale=" + size + ",fps=" + fps +
+                           ",loop=loop=-1:size=" + std::to_string(loop_frames) + ":start=0,setpts=N/(" + fps + "*TB)";
+            } else {
+                // Static background with loop
+                bg_inputs << "-stream_loop -1 -i \"" << to_ffmpeg_path(config.assetBgVideo) << "\" ";
+                bg_chain = "[0:v]setpts=PTS-STARTPTS,scale=" + size;
+                if (options.draft) bg_chain += ",fps=" + fps;
+            }
         }
-        
+        std::string overlay_filter;
+        if (apply_overlay) {
+            overlay_filter = ",drawbox=x=0:y=0:w=iw:h=ih:color=" + config.overlayColor + ":t=fill";
+        }
+        std::string subtitles_filter = ",ass='" + ass_ffmpeg_path + "':fontsdir='" + fonts_ffmpeg_path + "'";
+        int video_input_count = bgInputFiles.empty() ? 1 : static_cast<int>(bgInputFiles.size());
+
+        // --prerender-text: every distinct look of the subtitles is rasterized once and
+        // overlaid as a timed slideshow, so libass no longer renders every frame
+        std::string text_layer_args;
+        if (options.prerenderText) {
+            TextLayers::Plan layer_plan = TextLayers::plan(ass_filename);
+            json layerInputs = {
+                {"version", kTextLayerCacheVersion},
+                {"sheet", layer_plan.sheet},
+                {"width", picture_config.width},
+                {"height", picture_config.height},
+                {"fonts", RenderCache::describeFonts(config)}
+            };
+            fs::path layer_dir = options.noCache
+                ? fs::temp_directory_path() / "qvm_text_layers"
+                : CacheUtils::getCacheRoot() / "text_layers" / CacheUtils::hashString(layerInputs.dump());
+            // Only the images are cached: the sheet is the same for any timing of the same
+            // looks, so the timeline (reciter, intro length, ...) is written for every render
+            fs::path layer_done = layer_dir / "images.done";
+            fs::path layer_list = fs::temp_directory_path() / "qvm_text_layers.ffconcat";
+            if (!options.noCache && fs::exists(layer_done)) {
+                std::cout << "✅ Reusing cached text layers: " << layer_dir << std::endl;
+            } else {
+                std::error_code ec;
+                fs::remove_all(layer_dir, ec);
+                fs::create_directories(layer_dir);
+                fs::path sheet = layer_dir / "sheet.ass";
+                {
+                    std::ofstream sheet_file(sheet);
+                    if (!sheet_file.is_open()) throw std::runtime_error("Failed to create text layer script.");
+                    sheet_file << layer_plan.sheet;
+                }
+                // One second per image on a transparent canvas at the output size
+                std::ostringstream layer_cmd;
+                layer_cmd << "ffmpeg -y -f lavfi -i \"color=c=black@0.0:s=" << picture_config.width << "x"
+                          << picture_config.height << ":r=1:d=" << layer_plan.images << ",format=rgba\" "
+                          << "-vf \"ass='" << to_ffmpeg_filter_path(sheet) << "':fontsdir='" << fonts_ffmpeg_path
+                          << "':alpha=1\" -start_number 0 "
+                          << "\"" << to_ffmpeg_path(layer_dir / "layer_%05d.png") << "\"";
+                std::cout << "\nRendering " << layer_plan.images << " text layers:\n" << layer_cmd.str() << std::endl << std::endl;
+                if (processExecutor->execute(layer_cmd.str()) != 0) {
+                    throw std::runtime_error("Text layer rendering failed");
+                }
+                // Written last: its presence marks a complete set of images
+                std::ofstream(layer_done) << layer_plan.images << "\n";
+            }
+            TextLayers::writeConcatList(layer_plan, layer_dir, layer_list);
+            text_layer_args = "-f concat -safe 0 -i \"" + to_ffmpeg_path(layer_list) + "\" ";
+        }
+        // Text on the picture; layerInput is the index the text layer input gets in that command
+        auto burn_text = [&](int layerInput) -> std::string {
+            if (text_layer_args.empty()) return subtitles_filter;
+            return "[tb];[tb][" + std::to_string(layerInput) + ":v]overlay=eof_action=pass";
+        };
+
         // Handle audio differently for gapped vs gapless
-        if (config.recitationMode == RecitationMode::GAPLESS) {
+        bool gapless = config.recitationMode == RecitationMode::GAPLESS;
+        std::ostringstream audio_inputs;
+        if (gapless) {
             // For gapless: use single surah audio file with precise trimming
             if (verses.empty()) throw std::runtime_error("No verses to render");
             
@@ -202,41 +629,11 @@ void VideoGenerator::generateVideo(const CLIOptions& options,
                 : measuredAudioDuration;
             total_duration = intro_duration + pause_after_intro_duration + audioDuration;
             
-            final_cmd << "-f lavfi -t " << (intro_duration + pause_after_intro_duration) << " -i anullsrc=r=44100:cl=stereo ";
+            audio_inputs << "-f lavfi -t " << (intro_duration + pause_after_intro_duration) << " -i anullsrc=r=44100:cl=stereo ";
             if (!customClip) {
-                final_cmd << "-ss " << startTime << " -t " << trimmedDuration << " ";
-            }
-            final_cmd << "-i \"" << to_ffmpeg_path(audioPath) << "\" ";
-            
-            // Build filter complex
-            final_cmd << "-filter_complex \"";
-            
-            // Handle video part
-            if (!bgInputFiles.empty()) {
-                // Dynamic backgrounds - use the pre-built filter complex
-                final_cmd << bgFilterComplex;
-            } else {
-                // Static background
-                final_cmd << "[0:v]setpts=PTS-STARTPTS,scale=" << config.width << ":" << config.height;
+                audio_inputs << "-ss " << startTime << " -t " << trimmedDuration << " ";
             }
-            
-            // Add overlay if needed
-            if (apply_overlay) {
-                final_cmd << ",drawbox=x=0:y=0:w=iw:h=ih:color=" << config.overlayColor << ":t=fill";
-            }
-            
-            // Add subtitles
-            final_cmd << ",ass='" << ass_ffmpeg_path << "':fontsdir='" 
-                      << fonts_ffmpeg_path << "'[v];";
-            
-            // Handle audio concatenation
-            int audioInputIndex = bgInputFiles.empty() ? 1 : bgInputFiles.size();
-            final_cmd << "[" << audioInputIndex << ":a][" << (audioInputIndex + 1) << ":a]concat=n=2:v=0:a=1[a]\" ";
-            
-            // Map outputs
-            final_cmd << "-map \"[v]\" -map \"[a]\" "
-                      << "-t " << total_duration << " ";
-                      
+            audio_inputs << "-i \"" << to_ffmpeg_path(audioPath) << "\" ";
         } else {
             // For gapped: concatenate individual ayah audio files
             std::string concat_file_path = (fs::temp_directory_path() / "audiolist.txt").string();
@@ -252,77 +649,565 @@ void VideoGenerator::generateVideo(const CLIOptions& options,
             for(const auto& verse : verses) totalVideoDuration += verse.durationInSeconds;
             total_duration = totalVideoDuration;
             
-            int audioInputIndex = bgInputFiles.empty() ? 1 : bgInputFiles.size();
-            final_cmd << "-itsoffset " << (intro_duration + pause_after_intro_duration) << " "
-                      << "-f concat -safe 0 -i \"" << to_ffmpeg_path(concat_file_path) << "\" ";
-            
-            // Build filter complex
-            final_cmd << "-filter_complex \"";
-            
-            // Handle video part
-            if (!bgInputFiles.empty()) {
-                // Dynamic backgrounds - use the pre-built filter complex
-                final_cmd << bgFilterComplex;
+            audio_inputs << "-itsoffset " << (intro_duration + pause_after_intro_duration) << " "
+                         << "-f concat -safe 0 -i \"" << to_ffmpeg_path(concat_file_path) << "\" ";
+        }
+
+        // Gapless prepends the intro silence in the graph; gapped maps the concat input directly
+        bool audio_in_graph = gapless;
+        std::string audio_codec = "-c:a aac -b:a 128k";
+        auto audio_filter = [&](int audioInputIndex) -> std::string {
+            if (!audio_in_graph) return "";
+            return ";[" + std::to_string(audioInputIndex) + ":a][" + std::to_string(audioInputIndex + 1) +
+                   ":a]concat=n=2:v=0:a=1[a]";
+        };
+        auto audio_map = [&](int audioInputIndex) -> std::string {
+            return audio_in_graph ? "\"[a]\"" : std::to_string(audioInputIndex) + ":a";
+        };
+
+        // The finished track depends only on the recitation, so later renders copy it
+        if (!options.noCache) {
+            json trackInputs = {
+                {"version", kAudioTrackCacheVersion},
+                {"mode", gapless ? "gapless" : "gapped"},
+                {"reciterId", config.reciterId},
+                {"range", {{"surah", options.surah}, {"from", options.from}, {"to", options.to}}},
+                {"lead", intro_duration + pause_after_intro_duration},
+                {"duration", total_duration},
+                {"args", audio_inputs.str()}
+            };
+            json files = json::array();
+            json timings = json::array();
+            for (const auto& verse : verses) {
+                files.push_back(statFile(verse.localAudioPath));
+                timings.push_back({verse.durationInSeconds, verse.timestampFromMs, verse.timestampToMs});
+            }
+            trackInputs["files"] = files;
+            trackInputs["timings"] = timings;
+            fs::path track = CacheUtils::getCacheRoot() / "audio_tracks" /
+                             (CacheUtils::hashString(trackInputs.dump()) + ".m4a");
+
+            if (CacheUtils::fileIsValid(track)) {
+                std::cout << "✅ Reusing cached audio track: " << track << std::endl;
             } else {
-                // Static background
-                final_cmd << "[0:v]setpts=PTS-STARTPTS,scale=" << config.width << ":" << config.height;
+                fs::create_directories(track.parent_path());
+                fs::path partial = track;
+                partial.replace_extension(".partial.m4a");
+                std::ostringstream track_cmd;
+                track_cmd << "ffmpeg -y " << audio_inputs.str();
+                if (gapless) {
+                    track_cmd << "-filter_complex \"" << audio_filter(0).substr(1) << "\" ";
+                } else {
+                    // Pad the -itsoffset lead with real silence so the track starts at zero
+                    track_cmd << "-af aresample=async=1:first_pts=0 ";
+                }
+                track_cmd << "-map " << audio_map(0) << " -vn "
+                          << "-t " << total_duration << " "
+                          << audio_codec << " "
+                          << "\"" << to_ffmpeg_path(partial) << "\"";
+                std::cout << "\nEncoding audio track:\n" << track_cmd.str() << std::endl << std::endl;
+                int exit_code = processExecutor->execute(track_cmd.str());
+                std::error_code ec;
+                if (exit_code == 0 && CacheUtils::fileIsValid(partial)) {
+                    fs::rename(partial, track, ec);
+                } else {
+                    fs::remove(partial, ec);
+                }
+                if (!CacheUtils::fileIsValid(track)) {
+                    std::cerr << "Warning: Audio track encode failed; encoding audio with the video" << std::endl;
+                }
             }
-            
-            // Add overlay if needed
-            if (apply_overlay) {
-                final_cmd << ",drawbox=x=0:y=0:w=iw:h=ih:color=" << config.overlayColor << ":t=fill";
+
+            if (CacheUtils::fileIsValid(track)) {
+                audio_inputs.str("");
+                audio_inputs << "-i \"" << to_ffmpeg_path(track) << "\" ";
+                audio_in_graph = false;
+                audio_codec = "-c:a copy";
             }
-            
-            // Add subtitles
-            final_cmd << ",ass='" << ass_ffmpeg_path << "':fontsdir='" 
-                      << fonts_ffmpeg_path << "'[v]\" ";
-            
-            // Map outputs
-            final_cmd << "-map \"[v]\" -map " << audioInputIndex << ":a "
-                      << "-t " << totalVideoDuration << " ";
         }
 
-        // Add encoding options
-        final_cmd << video_codec.str() << " "
-                  << "-c:a aac -b:a 128k "
-                  << "-pix_fmt " << config.pixelFormat << " "
-                  << "-movflags +faststart "
-                  << "-threads 8 "
-                  << "\"" << options.output << "\"";
+        std::string encode_args = video_codec + "-pix_fmt " + config.pixelFormat + " ";
+        VerseIndex::Index verse_index = VerseIndex::build(options, config, verses);
+        std::vector<double> keyframes = keyframeTimes(verse_index, ass_filename);
+        std::string progress_args = options.emitProgress ? "-progress pipe:1 -nostats -loglevel warning " : "";
+        auto run = [&](const std::string& cmd, double duration) {
+            std::cout << "\nExecuting FFmpeg command:\n" << cmd << std::endl << std::endl;
+            if (options.emitProgress) {
+                processExecutor->executeWithProgress(cmd, duration);
+            } else {
+                int exit_code = processExecutor->execute(cmd);
+                if (exit_code != 0) throw std::runtime_error("FFmpeg execution failed");
+            }
+        };
 
-        std::cout << "\nExecuting FFmpeg command:\n" << final_cmd.str() << std::endl << std::endl;
-        
-        if (options.emitProgress) {
-            processExecutor->executeWithProgress(final_cmd.str(), total_duration);
-        } else {
-            int exit_code = processExecutor->execute(final_cmd.str());
+        // --upload-r2: the last encode writes fragmented MP4 to stdout, which the uploader
+        // consumes part by part while ffmpeg is still encoding. Fragmented MP4 needs no
+        // seek back to the header, so the video never touches the local disk.
+        bool streaming = uploader && !options.uploadKey.empty();
+        auto output_args = [&](const std::string& path) {
+            if (streaming) return std::string("-f mp4 -movflags +frag_keyframe+empty_moov+default_base_moof pipe:1");
+            return containerArgs(options.container, path) + "\"" + path + "\"";
+        };
+        // Players on Apple platforms only accept HEVC in MP4 under the hvc1 tag; Matroska
+        // rejects it, so the tag follows the file each command writes (piped output is MP4)
+        auto hevc_tag = [&](const fs::path& target, bool piped) {
+            return codec == "libx265" && (piped || !isMatroska(target)) ? std::string("-tag:v hvc1 ") : std::string();
+        };
+        auto deliver = [&](const std::string& cmd, double duration) {
+            if (!streaming) {
+                run(cmd, duration);
+                return;
+            }
+            std::cout << "\nStreaming FFmpeg output to " << options.uploadKey << ":\n" << cmd << std::endl << std::endl;
+            bool uploaded = false;
+            int exit_code = processExecutor->executeStreaming(cmd, [&](const Interfaces::OutputReader& reader) {
+                uploaded = uploader->upload(reader, options.uploadKey);
+            });
             if (exit_code != 0) throw std::runtime_error("FFmpeg execution failed");
+            if (!uploaded) throw std::runtime_error("Upload of " + options.uploadKey + " failed");
+        };
+
+        // Frame encodes feed the render history when they are comparable with other renders
+        bool time_encodes = stats && !options.draft && !options.softSubtitles && !still_background &&
+                            !streaming && options.variants.empty();
+        auto timed_encode = [&](double seconds, const std::function<bool()>& encode) {
+            if (!time_encodes) return encode();
+            auto started = std::chrono::steady_clock::now();
+            RenderHistory::Usage before = RenderHistory::usage();
+            bool ok = encode();
+            if (ok) {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+                stats->videoSeconds += seconds;
+                stats->wallSeconds += elapsed.count();
+                stats->cpuSeconds += RenderHistory::usage().cpuSeconds - before.cpuSeconds;
+            }
+            return ok;
+        };
+
+        // The intro card (and a leading Bismillah) is identical across renders of the
+        // same range and look, so it is encoded once and joined to the body by stream copy
+        bool rendered = false;
+        double opening_end = openingDuration(options, config, verses);
+        if (!options.noCache && options.variants.empty() && !options.softSubtitles &&
+            opening_end >= kMinOpeningSeconds && total_duration > opening_end + 1.0) {
+            json openingInputs = {
+                {"encoder", encode_args},
+                {"background", describeInputs(bg_inputs.str(), bgInputFiles, bgManager.usesConcatList(), config)},
+                {"chain", bg_chain + overlay_filter},
+                {"fonts", RenderCache::describeFonts(config)},
+                {"textLayers", options.prerenderText}
+            };
+            fs::path opening = openingCachePath(ass_filename, opening_end, openingInputs);
+
+            if (CacheUtils::fileIsValid(opening)) {
+                std::cout << "✅ Reusing cached opening: " << opening << std::endl;
+            } else {
+                fs::create_directories(opening.parent_path());
+                fs::path partial = opening;
+                partial.replace_extension(".partial.mp4");
+                std::ostringstream opening_cmd;
+                opening_cmd << "ffmpeg -y " << bg_inputs.str() << text_layer_args << filter_threads
+                            << "-filter_complex \"" << bg_chain << ",trim=end=" << opening_end
+                            << overlay_filter << burn_text(video_input_count) << "[v]\" "
+                            << "-map \"[v]\" -an " << encode_args << keyframeArgs(keyframes, 0.0, opening_end)
+                            << "\"" << to_ffmpeg_path(partial) << "\"";
+                std::cout << "\nEncoding opening segment:\n" << opening_cmd.str() << std::endl << std::endl;
+                bool encoded = timed_encode(opening_end, [&] {
+                    return processExecutor->execute(opening_cmd.str()) == 0 && CacheUtils::fileIsValid(partial);
+                });
+                std::error_code ec;
+                if (encoded) {
+                    fs::rename(partial, opening, ec);
+                } else {
+                    fs::remove(partial, ec);
+                }
+                if (!CacheUtils::fileIsValid(opening)) {
+                    std::cerr << "Warning: Opening segment encode failed; rendering in a single pass" << std::endl;
+                }
+            }
+
+            if (CacheUtils::fileIsValid(opening)) {
+                // trim keeps timestamps, so the subtitles still use the global timeline
+                fs::path body = fs::temp_directory_path() / "qvm_body.mp4";
+                std::ostringstream body_cmd;
+                body_cmd << "ffmpeg " << progress_args << "-y " << bg_inputs.str() << text_layer_args
+                         << filter_threads << "-filter_complex \"" << bg_chain << ",trim=start=" << opening_end
+                         << overlay_filter << burn_text(video_input_count) << ",setpts=PTS-STARTPTS[v]\" "
+                         << "-map \"[v]\" -an -t " << (total_duration - opening_end) << " " << encode_args
+                         << keyframeArgs(keyframes, opening_end, total_duration)
+                         << "\"" << to_ffmpeg_path(body) << "\"";
+                timed_encode(total_duration - opening_end, [&] {
+                    run(body_cmd.str(), total_duration - opening_end);
+                    return true;
+                });
+
+                fs::path segments = fs::temp_directory_path() / "qvm_segments.ffconcat";
+                {
+                    std::ofstream list(segments);
+                    if (!list.is_open()) throw std::runtime_error("Failed to create segment list file.");
+                    list << "ffconcat version 1.0\n";
+                    list << "file '" << to_ffmpeg_path(fs::absolute(opening)) << "'\n";
+                    list << "file '" << to_ffmpeg_path(fs::absolute(body)) << "'\n";
+                }
+
+                std::ostringstream mux_cmd;
+                mux_cmd << "ffmpeg -y -f concat -safe 0 -i \"" << to_ffmpeg_path(segments) << "\" "
+                        << audio_inputs.str();
+                std::string mux_audio_filter = audio_filter(1);
+                if (!mux_audio_filter.empty()) {
+                    mux_cmd << "-filter_complex \"" << mux_audio_filter.substr(1) << "\" ";
+                }
+                mux_cmd << "-map 0:v -map " << audio_map(1) << " "
+                        << "-t " << total_duration << " "
+                        << "-c:v copy " << hevc_tag(options.output, streaming) << audio_codec << " "
+                        << output_args(to_ffmpeg_path(containerTarget(options.container, options.output)));
+                deliver(mux_cmd.str(), total_duration);
+
+                std::error_code ec;
+                fs::remove(body, ec);
+                fs::remove(segments, ec);
+                rendered = true;
+            }
+        }
+
+        // Config and verses as a --translation <id> render would see them
+        auto translated_inputs = [&](int translationId, AppConfig& variantConfig, std::vector<VerseData>& variantVerses) {
+            variantConfig = withTranslation(config, options, translationId);
+            variantVerses = verses;
+            for (auto& verse : variantVerses) {
+                try {
+                    verse.translation = CacheUtils::getTranslationText(translationId, verse.verseKey);
+                } catch (const std::exception& e) {
+                    std::cerr << "Warning: Could not load translation " << translationId
+                              << " for " << verse.verseKey << ": " << e.what() << std::endl;
+                    verse.translation.clear();
+                }
+            }
+        };
+
+        // Soft subtitles: the picture (background, Arabic text, audio) is cached apart from
+        // the translations, so adding or correcting a language only needs a remux
+        std::string render_target = to_ffmpeg_path(containerTarget(options.container, options.output));
+        fs::path picture;
+        if (options.softSubtitles) {
+            json pictureInputs = {
+                {"version", kPictureCacheVersion},
+                {"arabic", CacheUtils::hashFile(ass_filename)},
+                {"encoder", encode_args},
+                {"background", describeInputs(bg_inputs.str(), bgInputFiles, bgManager.usesConcatList(), config)},
+                {"chain", bg_chain + overlay_filter},
+                {"fonts", RenderCache::describeFonts(config)},
+                {"textLayers", options.prerenderText},
+                {"audio", audio_inputs.str()},
+                {"duration", total_duration}
+            };
+            if (options.noCache) {
+                picture = fs::temp_directory_path() / "qvm_picture.mkv";
+                render_target = picture.string();
+            } else {
+                picture = CacheUtils::getCacheRoot() / "pictures" / (CacheUtils::hashString(pictureInputs.dump()) + ".mkv");
+                if (CacheUtils::fileIsValid(picture)) {
+                    std::cout << "✅ Reusing cached picture: " << picture << std::endl;
+                    rendered = true;
+                } else {
+                    fs::create_directories(picture.parent_path());
+                    fs::path partial = picture;
+                    partial.replace_extension(".partial.mkv");
+                    render_target = partial.string();
+                }
+            }
+        }
+
+        if (!rendered) {
+            // Every output shares one decode of the background and one pass over the audio
+            struct Output {
+                std::string path;
+                std::string subtitles;
+                std::string scale;
+                int crf;
+            };
+            // Text layers come after the background and audio inputs
+            int layer_input = video_input_count + (audio_in_graph ? 2 : 1);
+            std::vector<Output> outputs{{render_target, burn_text(layer_input), "", config.crf}};
+            // With soft subtitles, translation variants become tracks of the main output
+            std::vector<RenderVariant> burned_variants = options.softSubtitles ? std::vector<RenderVariant>{} : options.variants;
+            for (const auto& variant : burned_variants) {
+                AppConfig variant_config = config;
+                std::vector<VerseData> variant_verses = verses;
+                if (variant.translationId >= 0) {
+                    // Only the translation text and its font differ from the main output
+                    translated_inputs(variant.translationId, variant_config, variant_verses);
+                }
+                std::string scale;
+                if (variant.width > 0) {
+                    variant_config.width = variant.width;
+                    variant_config.height = variant.height;
+                    // Keep text proportional to the frame; the layout engine handles wrapping
+                    double font_scale = std::min(static_cast<double>(variant.width) / config.width,
+                                                 static_cast<double>(variant.height) / config.height);
+                    variant_config.arabicFont.size = static_cast<int>(std::lround(config.arabicFont.size * font_scale));
+                    variant_config.translationFont.size = static_cast<int>(std::lround(config.translationFont.size * font_scale));
+                    variant_config.surahHeaderFont.size = static_cast<int>(std::lround(config.surahHeaderFont.size * font_scale));
+                    // crop takes width and height as separate options; only scale accepts WxH
+                    std::string width = std::to_string(variant.width), height = std::to_string(variant.height);
+                    scale = "scale=" + width + "x" + height + ":force_original_aspect_ratio=increase,crop=" +
+                            width + ":" + height;
+                }
+                std::string variant_ass = SubtitleBuilder::buildAssFile(variant_config, options, variant_verses, intro_duration,
+                                                                        pause_after_intro_duration, segmentManager,
+                                                                        variantOutputPath("subtitles.ass", variant).string());
+                outputs.push_back({
+                    to_ffmpeg_path(containerTarget(options.container, variantOutputPath(options.output, variant))),
+                    ",ass='" + to_ffmpeg_filter_path(fs::path(variant_ass)) + "':fontsdir='" + fonts_ffmpeg_path + "'",
+                    scale,
+                    variant.crf >= 0 ? variant.crf : config.crf
+                });
+            }
+
+            std::ostringstream graph;
+            graph << bg_chain;
+            if (outputs.size() == 1) {
+                graph << overlay_filter << outputs[0].subtitles << "[v0]";
+            } else {
+                graph << ",split=" << outputs.size();
+                for (size_t i = 0; i < outputs.size(); ++i) graph << "[b" << i << "]";
+                for (size_t i = 0; i < outputs.size(); ++i) {
+                    graph << ";[b" << i << "]" << (outputs[i].scale.empty() ? "null" : outputs[i].scale)
+                          << overlay_filter << outputs[i].subtitles << "[v" << i << "]";
+                }
+            }
+            graph << audio_filter(video_input_count);
+            if (audio_in_graph && outputs.size() > 1) {
+                graph << ";[a]asplit=" << outputs.size();
+                for (size_t i = 0; i < outputs.size(); ++i) graph << "[a" << i << "]";
+            }
+
+            // Build ffmpeg command with all inputs
+            std::stringstream final_cmd;
+            // Progress lines share stdout, so a streamed render goes without them
+            bool stream_pass = streaming && !options.softSubtitles;
+            final_cmd << "ffmpeg " << (stream_pass ? "" : progress_args) << "-y "
+                      << bg_inputs.str()
+                      << audio_inputs.str()
+                      << text_layer_args
+                      << filter_threads
+                      << "-filter_complex \"" << graph.str() << "\" ";
+
+            for (size_t i = 0; i < outputs.size(); ++i) {
+                std::string output_audio = audio_map(video_input_count);
+                if (audio_in_graph && outputs.size() > 1) output_audio = "\"[a" + std::to_string(i) + "]\"";
+                final_cmd << "-map \"[v" << i << "]\" -map " << output_audio << " "
+                          << "-t " << total_duration << " ";
+
+                // Add encoding options
+                final_cmd << codec_args(outputs[i].crf, static_cast<int>(outputs.size()))
+                          << hevc_tag(outputs[i].path, stream_pass)
+                          << keyframeArgs(keyframes, 0.0, total_duration)
+                          << audio_codec << " "
+                          << "-pix_fmt " << config.pixelFormat << " "
+                          << (stream_pass ? output_args(outputs[i].path)
+                                          : containerArgs(options.container, outputs[i].path) + "\"" + outputs[i].path + "\"")
+                          << " ";
+            }
+
+            if (stream_pass) {
+                deliver(final_cmd.str(), total_duration);
+            } else {
+                timed_encode(total_duration, [&] {
+                    run(final_cmd.str(), total_duration);
+                    return true;
+                });
+            }
+        }
+
+        if (options.softSubtitles) {
+            if (render_target != options.output && fs::path(render_target) != picture) {
+                // A cache miss rendered to the partial file next to the cache entry
+                std::error_code ec;
+                fs::rename(render_target, picture, ec);
+                if (ec) throw std::runtime_error("Failed to store picture: " + ec.message());
+            }
+
+            // One translation track per language, main translation first
+            std::vector<std::pair<std::string, std::string>> tracks;
+            auto add_track = [&](const AppConfig& trackConfig, const std::vector<VerseData>& trackVerses,
+                                 const std::string& fileName) {
+                std::string track = SubtitleBuilder::buildAssFile(trackConfig, options, trackVerses, intro_duration,
+                                                                  pause_after_intro_duration, segmentManager, fileName,
+                                                                  SubtitleBuilder::Layers::Translation);
+                tracks.emplace_back(track, LocalizationUtils::getLanguageCode(trackConfig) + " (t" +
+                                           std::to_string(trackConfig.translationId) + ")");
+            };
+            add_track(config, verses, "subtitles_track.ass");
+            for (const auto& variant : options.variants) {
+                if (variant.translationId < 0 || variant.width > 0) continue;
+                AppConfig track_config;
+                std::vector<VerseData> track_verses;
+                translated_inputs(variant.translationId, track_config, track_verses);
+                add_track(track_config, track_verses, variantOutputPath("subtitles_track.ass", variant).string());
+            }
+
+            // mov_text keeps MP4 playable everywhere; Matroska carries the styled ASS as is
+            std::ostringstream mux_cmd;
+            mux_cmd << "ffmpeg -y -i \"" << to_ffmpeg_path(picture) << "\" ";
+            for (const auto& track : tracks) {
+                mux_cmd << "-i \"" << to_ffmpeg_path(track.first) << "\" ";
+            }
+            mux_cmd << "-map 0:v -map 0:a ";
+            for (size_t i = 0; i < tracks.size(); ++i) {
+                mux_cmd << "-map " << (i + 1) << ":0 ";
+            }
+            bool ass_tracks = isMatroska(options.output) && !streaming;
+            mux_cmd << "-c:v copy " << hevc_tag(options.output, streaming) << "-c:a copy -c:s " << (ass_tracks ? "ass" : "mov_text") << " ";
+            for (size_t i = 0; i < tracks.size(); ++i) {
+                mux_cmd << "-metadata:s:s:" << i << " title=\"" << tracks[i].second << "\" ";
+            }
+            mux_cmd << "-disposition:s:0 default "
+                    << output_args(options.output);
+            deliver(mux_cmd.str(), total_duration);
+
+            if (options.noCache) {
+                std::error_code ec;
+                fs::remove(picture, ec);
+            }
         }
 
         // Cleanup temporary background video files
         bgManager.cleanup();
 
+        if (streaming) {
+            std::cout << "\n✅ Render complete! Video uploaded to: " << options.uploadKey << std::endl;
+            return options.uploadKey;
+        }
+
         std::cout << "\n✅ Render complete! Video saved to: " << options.output << std::endl;
 
         //format output filename - to save Arabic surahname in filename
-        std::string englishName = QuranData::surahNames.at(options.surah);
-        std::string arabicName = LocalizationUtils::getLocalizedSurahName(options.surah, "ar");
-        std::string filename = "Surah - " + std::to_string(options.surah) + "_" + std::to_string(options.from) + "_" + std::to_string(options.to) + " - " + englishName + " - " + arabicName + " - t" + std::to_string(options.translationId) + "_r" + std::to_string(options.reciterId) + ".mp4";
-        fs::path outputPath = fs::path("out") / fs::u8path(filename);
+        fs::path outputPath = finalOutputPath(options);
+        if (options.softSubtitles) {
+            // Keep the requested container; translation variants are tracks of this file
+            outputPath.replace_extension(fs::path(options.output).extension());
+        }
+        for (const auto& variant : options.softSubtitles ? std::vector<RenderVariant>{} : options.variants) {
+            // Translation variants take the name a --translation run would have produced
+            CLIOptions variantOptions = options;
+            RenderVariant suffix = variant;
+            if (variant.translationId >= 0) {
+                variantOptions.translationId = variant.translationId;
+                suffix.translationId = -1;
+            }
+            try {
+                fs::path variantPath = moveOutput(variantOutputPath(options.output, variant),
+                                                  variantOutputPath(finalOutputPath(variantOptions), suffix),
+                                                  options.container);
+                std::cout << "✅ Rendition saved to: " << variantPath << std::endl;
+                writeVerseIndex(verse_index, variantPath);
+            } catch (const std::exception& e) {
+                std::cerr << "❌ Failed to rename rendition: " << e.what() << std::endl;
+            }
+        }
         try
         {
-            fs::rename(options.output, outputPath);
+            outputPath = moveOutput(options.output, outputPath, options.container);
             std::cout << "✅ File renamed to: " << outputPath << std::endl;
+            writeVerseIndex(verse_index, outputPath);
+            return outputPath.string();
         }
         catch (const std::exception& e)
         {
             std::cerr << "❌ Failed to rename file: " << e.what() << std::endl;
         }
-
+        return options.output;
 
     } catch(const std::exception& e) {
         std::cerr << "❌ An error occurred during video generation: " << e.what() << std::endl;
     }
+    return "";
+}
+
+double VideoGenerator::resolveStillTime(const std::string& at, const VerseIndex::Index& index) {
+    static const std::regex secondsPattern(R"(\s*(\d+(?:\.\d+)?)\s*)");
+    static const std::regex verseKeyPattern(R"(\s*(\d+):(\d+)\s*)");
+    std::smatch match;
+    if (std::regex_match(at, match, secondsPattern)) {
+        return std::stod(match[1]);
+    }
+    if (std::regex_match(at, match, verseKeyPattern)) {
+        std::string key = std::to_string(std::stoi(match[1])) + ":" + std::to_string(std::stoi(match[2]));
+        for (const auto& entry : index.verses) {
+            if (entry.verseKey != key) continue;
+            return entry.start + std::min(kStillVerseOffsetSeconds, (entry.end - entry.start) / 2.0);
+        }
+        throw std::invalid_argument("Verse " + key + " is not part of this render");
+    }
+    throw std::invalid_argument("Invalid --still value '" + at + "' (expected seconds or a verse key)");
+}
+
+std::string VideoGenerator::renderStill(const CLIOptions& options,
+                                        const AppConfig& config,
+                                        const std::vector<VerseData>& verses,
+                                        std::shared_ptr<Interfaces::IProcessExecutor> processExecutor,
+                                        const VerseSegmentation::Manager* segmentManager,
+                                        const std::string& at) {
+    double time = resolveStillTime(at, VerseIndex::build(options, config, verses));
+
+    // Same duration generateVideo hands the background selection, so the same clips come up
+    double total_duration = config.introDuration + config.pauseAfterIntroDuration;
+    for (const auto& verse : verses) total_duration += verse.durationInSeconds;
+    time = std::min(time, total_duration);
+
+    AppConfig picture_config = options.draft ? draftConfig(config) : config;
+    SubtitleBuilder::Layers burned_layers = options.softSubtitles ? SubtitleBuilder::Layers::Arabic
+                                                                  : SubtitleBuilder::Layers::All;
+    std::string ass_filename = SubtitleBuilder::buildAssFile(config, options, verses, config.introDuration,
+                                                             config.pauseAfterIntroDuration, segmentManager,
+                                                             "subtitles_still.ass", burned_layers);
+    std::string subtitles_filter = ",ass='" + to_ffmpeg_filter_path(fs::path(ass_filename)) + "':fontsdir='" +
+                                   to_ffmpeg_filter_path(fs::absolute(config.assetFolderPath) / "fonts") + "'";
+    std::string size = std::to_string(picture_config.width) + ":" + std::to_string(picture_config.height);
+    std::string overlay_filter = ",drawbox=x=0:y=0:w=iw:h=ih:color=" + config.overlayColor + ":t=fill";
+    bool overlay_visible = BackgroundVideo::overlayVisible(config.overlayColor);
+
+    // Seek straight to the one clip on screen; setpts puts its frame back on the render's
+    // timeline so the subtitles show their state at that instant
+    std::string source = config.assetBgVideo;
+    double offset = time;
+    std::ostringstream chain;
+    chain << std::fixed << std::setprecision(3) << "[0:v]setpts=PTS-STARTPTS+" << time << "/TB";
+    BackgroundVideo::Manager bgManager(picture_config, options);
+    std::vector<std::string> bgInputFiles;
+    std::optional<std::pair<BackgroundVideo::VideoSegment, double>> located;
+    if (config.videoSelection.enableDynamicBackgrounds &&
+        !bgManager.buildFilterComplex(total_duration, bgInputFiles).empty()) {
+        located = bgManager.locate(time);
+    }
+    if (located) {
+        source = located->first.path;
+        offset = located->second;
+        chain << (located->first.matchesOutput ? "" : ",scale=" + size) << ",setsar=1";
+        if (overlay_visible && !located->first.overlayBaked) chain << overlay_filter;
+    } else {
+        // The static background loops for the whole render
+        double clip_duration = Audio::CustomAudioProcessor::probeDuration(config.assetBgVideo);
+        if (clip_duration > 0.0) offset = std::fmod(time, clip_duration);
+        chain << ",scale=" << size;
+        if (overlay_visible) chain << overlay_filter;
+    }
+    chain << subtitles_filter << "[v]";
+
+    fs::path still = fs::path(options.output).replace_extension(".png");
+    if (!still.parent_path().empty()) fs::create_directories(still.parent_path());
+    std::ostringstream cmd;
+    cmd << std::fixed << std::setprecision(3)
+        << "ffmpeg -y -ss " << offset << " -i \"" << to_ffmpeg_path(source) << "\" "
+        << "-filter_complex \"" << chain.str() << "\" "
+        << "-map \"[v]\" -frames:v 1 -update 1 "
+        << "\"" << to_ffmpeg_path(still) << "\"";
+    std::cout << "\nRendering still at " << time << "s:\n" << cmd.str() << std::endl << std::endl;
+    int exit_code = processExecutor->execute(cmd.str());
+    bgManager.cleanup();
+    if (exit_code != 0) throw std::runtime_error("FFmpeg execution failed");
+    return still.string();
 }
 
 void VideoGenerator::generateThumbnail(const CLIOptions& options, const AppConfig& config, std::shared_ptr<Interfaces::IProcessExecutor> processExecutor) {
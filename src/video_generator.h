@@ -1,16 +1,66 @@
 #pragma once
 #include "types.h"
 #include "interfaces/IProcessExecutor.h"
+#include "interfaces/IStreamUploader.h"
 #include "verse_segmentation.h"
+#include "verse_index.h"
+#include <filesystem>
 #include <vector>
 #include <memory>
 
 namespace VideoGenerator {
-    void generateVideo(const CLIOptions& options, 
+    // Where a finished render ends up (out/ with the Arabic surah name)
+    std::filesystem::path finalOutputPath(const CLIOptions& options);
+
+    // --draft picture settings: shorter side at most 360 px, at most 15 fps. Subtitles are
+    // still laid out at the full size and scaled by libass, so positions stay proportional.
+    AppConfig draftConfig(const AppConfig& config);
+
+    // Frames needed to hold a clipSeconds background loop decoded at the picture size and
+    // frame rate, or 0 when they would not fit in budgetMb (the clip is re-decoded instead)
+    int loopBufferFrames(double clipSeconds, const AppConfig& picture, int budgetMb);
+
+    // "WxH[:CRF]" entries separated by commas; throws std::invalid_argument
+    std::vector<RenderVariant> parseRenditions(const std::string& spec);
+
+    // Comma-separated translation IDs, one same-size output each; throws std::invalid_argument
+    std::vector<RenderVariant> parseTranslations(const std::string& spec);
+
+    // Variants are written next to the main output with a "_WxH" / "_t<id>" suffix
+    std::filesystem::path variantOutputPath(const std::filesystem::path& base, const RenderVariant& variant);
+
+    // Time spent in the commands that encoded frames (opening, body or single pass), for
+    // the render history. Left at zero for renders whose encodes are not comparable: soft
+    // subtitles, still-background VFR, drafts, several outputs and streamed uploads.
+    struct EncodeStats {
+        double videoSeconds = 0.0;  // video those commands encoded
+        double wallSeconds = 0.0;
+        double cpuSeconds = 0.0;
+    };
+
+    // Returns the path of the rendered video, or an empty string when rendering failed.
+    // With an uploader and options.uploadKey the final encode is streamed straight to it
+    // and the uploaded key is returned instead; nothing is written to options.output.
+    std::string generateVideo(const CLIOptions& options, 
                        const AppConfig& config, 
                        const std::vector<VerseData>& verses, 
                        std::shared_ptr<Interfaces::IProcessExecutor> processExecutor,
-                       const VerseSegmentation::Manager* segmentManager = nullptr);
+                       const VerseSegmentation::Manager* segmentManager = nullptr,
+                       std::shared_ptr<Interfaces::IStreamUploader> uploader = nullptr,
+                       EncodeStats* stats = nullptr);
+    // --still: seconds ("12.5") or a verse key ("2:255", just after its text has faded in);
+    // throws std::invalid_argument for anything else or a verse outside the index
+    double resolveStillTime(const std::string& at, const VerseIndex::Index& index);
+
+    // One PNG of the render at `at`, built from the same background, overlay and subtitles as
+    // generateVideo but decoding a single frame. Returns the PNG path; throws on failure.
+    std::string renderStill(const CLIOptions& options,
+                            const AppConfig& config,
+                            const std::vector<VerseData>& verses,
+                            std::shared_ptr<Interfaces::IProcessExecutor> processExecutor,
+                            const VerseSegmentation::Manager* segmentManager,
+                            const std::string& at);
+
     void generateThumbnail(const CLIOptions& options, 
                            const AppConfig& config, 
                            std::shared_ptr<Interfaces::IProcessExecutor> processExecutor);
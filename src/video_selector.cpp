@@ -30,96 +30,97 @@ Selector::Selector(const std::string& metadataPath, unsigned int seed)
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open theme metadata: " + metadataPath);
     }
+    json metadata;
     file >> metadata;
+    compileMetadata(metadata);
 }
 
-std::pair<int, int> Selector::findRangeBoundsForVerse(int surah, int verse) {
-    std::string surahKey = std::to_string(surah);
-    if (!metadata.contains(surahKey)) {
-        return {-1, -1};
-    }
-    
-    const auto& surahData = metadata[surahKey];
-    for (auto it = surahData.begin(); it != surahData.end(); ++it) {
-        const std::string& range = it.key();
-        size_t dashPos = range.find('-');
-        if (dashPos == std::string::npos) continue;
+void Selector::compileMetadata(const json& metadata) {
+    for (auto surahIt = metadata.begin(); surahIt != metadata.end(); ++surahIt) {
+        // Skip "_comment" style keys and anything that is not a range table
+        if (!surahIt.value().is_object()) continue;
+        int surah = 0;
+        try {
+            surah = std::stoi(surahIt.key());
+        } catch (...) {
+            continue;
+        }
+        
+        auto& ranges = rangesBySurah[surah];
+        for (auto it = surahIt.value().begin(); it != surahIt.value().end(); ++it) {
+            const std::string& range = it.key();
+            size_t dashPos = range.find('-');
+            if (dashPos == std::string::npos) continue;
+            
+            ThemeRange entry;
+            try {
+                entry.startVerse = std::stoi(range.substr(0, dashPos));
+                entry.endVerse = std::stoi(range.substr(dashPos + 1));
+                entry.themes = it.value().get<std::vector<std::string>>();
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: Ignoring invalid theme range " << surah << ":" << range
+                          << " (" << e.what() << ")" << std::endl;
+                continue;
+            }
+            if (entry.endVerse < entry.startVerse) continue;
+            ranges.push_back(std::move(entry));
+        }
         
-        int start = std::stoi(range.substr(0, dashPos));
-        int end = std::stoi(range.substr(dashPos + 1));
+        std::sort(ranges.begin(), ranges.end(),
+                  [](const ThemeRange& a, const ThemeRange& b) {
+                      return a.startVerse < b.startVerse;
+                  });
         
-        if (verse >= start && verse <= end) {
-            return {start, end};
+        for (size_t i = 1; i < ranges.size(); ++i) {
+            if (ranges[i].startVerse <= ranges[i - 1].endVerse) {
+                std::cerr << "Warning: Overlapping theme ranges in surah " << surah << ": "
+                          << ranges[i - 1].startVerse << "-" << ranges[i - 1].endVerse << " and "
+                          << ranges[i].startVerse << "-" << ranges[i].endVerse << std::endl;
+            }
         }
     }
-    
-    return {-1, -1};
 }
 
-std::vector<std::string> Selector::findRangeForVerse(int surah, int verse) {
-    std::string surahKey = std::to_string(surah);
-    if (!metadata.contains(surahKey)) {
-        return {};
+const ThemeRange* Selector::findRangeForVerse(int surah, int verse) const {
+    auto surahIt = rangesBySurah.find(surah);
+    if (surahIt == rangesBySurah.end()) {
+        return nullptr;
     }
     
-    const auto& surahData = metadata[surahKey];
-    for (auto it = surahData.begin(); it != surahData.end(); ++it) {
-        const std::string& range = it.key();
-        size_t dashPos = range.find('-');
-        if (dashPos == std::string::npos) continue;
-        
-        int start = std::stoi(range.substr(0, dashPos));
-        int end = std::stoi(range.substr(dashPos + 1));
-        
-        if (verse >= start && verse <= end) {
-            return it.value().get<std::vector<std::string>>();
-        }
+    // Last range starting at or before the verse
+    const auto& ranges = surahIt->second;
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), verse,
+                               [](int v, const ThemeRange& r) { return v < r.startVerse; });
+    if (it == ranges.begin()) {
+        return nullptr;
     }
-    
-    return {};
+    --it;
+    return verse <= it->endVerse ? &*it : nullptr;
 }
 
 std::vector<VerseRangeSegment> Selector::getVerseRangeSegments(int surah, int from, int to) {
     std::vector<VerseRangeSegment> segments;
     
-    // Find all unique verse ranges that overlap with our requested range
-    std::map<std::string, VerseRangeSegment> rangeMap;
-    
+    // Ranges are sorted, so each lookup lets us jump straight past the range it found
     for (int verse = from; verse <= to; ++verse) {
-        auto bounds = findRangeBoundsForVerse(surah, verse);
-        if (bounds.first < 0) continue;
-        
-        std::string rangeKey = std::to_string(surah) + ":" + 
-                               std::to_string(bounds.first) + "-" + 
-                               std::to_string(bounds.second);
+        const ThemeRange* range = findRangeForVerse(surah, verse);
+        if (!range) continue;
         
-        if (rangeMap.find(rangeKey) == rangeMap.end()) {
-            VerseRangeSegment segment;
-            segment.rangeKey = rangeKey;
-            // Clamp to our requested range
-            segment.startVerse = std::max(bounds.first, from);
-            segment.endVerse = std::min(bounds.second, to);
-            segment.themes = findRangeForVerse(surah, verse);
-            segment.startTimeFraction = 0.0;
-            segment.endTimeFraction = 0.0; 
-            rangeMap[rangeKey] = segment;
-        } else {
-            // Update the end verse if needed
-            rangeMap[rangeKey].endVerse = std::max(rangeMap[rangeKey].endVerse, 
-                                                    std::min(bounds.second, to));
-        }
-    }
-    
-    // Convert to vector and sort by start verse
-    for (auto& [key, segment] : rangeMap) {
+        VerseRangeSegment segment;
+        segment.rangeKey = std::to_string(surah) + ":" + 
+                           std::to_string(range->startVerse) + "-" + 
+                           std::to_string(range->endVerse);
+        // Clamp to our requested range
+        segment.startVerse = std::max(range->startVerse, from);
+        segment.endVerse = std::min(range->endVerse, to);
+        segment.themes = range->themes;
+        segment.startTimeFraction = 0.0;
+        segment.endTimeFraction = 0.0;
         segments.push_back(segment);
+        
+        verse = segment.endVerse;
     }
     
-    std::sort(segments.begin(), segments.end(), 
-              [](const VerseRangeSegment& a, const VerseRangeSegment& b) {
-                  return a.startVerse < b.startVerse;
-              });
-    
     // Calculate time fractions based on verse counts
     int totalVerses = to - from + 1;
     double currentFraction = 0.0;
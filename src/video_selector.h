@@ -18,6 +18,13 @@ private:
     std::mt19937 gen;
 };
 
+// A themed verse range from the metadata, compiled once at load time
+struct ThemeRange {
+    int startVerse;
+    int endVerse;
+    std::vector<std::string> themes;
+};
+
 // A single entry in a range's playlist
 struct PlaylistEntry {
     std::string theme;
@@ -65,11 +72,14 @@ public:
         SelectionState& state);
 
 private:
-    nlohmann::json metadata;
+    // Per-surah ranges sorted by start verse; JSON is not consulted after load
+    std::map<int, std::vector<ThemeRange>> rangesBySurah;
     SeededRandom random;
     
-    std::vector<std::string> findRangeForVerse(int surah, int verse);
-    std::pair<int, int> findRangeBoundsForVerse(int surah, int verse);
+    void compileMetadata(const nlohmann::json& metadata);
+    
+    // Binary search for the range containing a verse (nullptr if none)
+    const ThemeRange* findRangeForVerse(int surah, int verse) const;
     
     // Build an interleaved playlist from themes and their videos
     std::vector<PlaylistEntry> buildPlaylist(
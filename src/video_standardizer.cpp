@@ -1,5 +1,10 @@
 #include "video_standardizer.h"
 #include "r2_client.h"
+#include "work_queue.h"
+#include "background_manifest.h"
+#include "cache_utils.h"
+#include "thread_policy.h"
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 #include <filesystem>
@@ -7,6 +12,10 @@
 #include <chrono>
 #include <iomanip>
 #include <algorithm>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 #include <nlohmann/json.hpp>
 
 extern "C" {
@@ -16,6 +25,345 @@ extern "C" {
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
+namespace {
+
+#ifdef _WIN32
+const char* kNullRedirect = " 2>NUL";
+#define QVM_POPEN _popen
+#define QVM_PCLOSE _pclose
+#else
+const char* kNullRedirect = " 2>/dev/null";
+#define QVM_POPEN popen
+#define QVM_PCLOSE pclose
+#endif
+
+std::mutex logMutex;
+
+void logLine(const std::string& message, bool error = false) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    (error ? std::cerr : std::cout) << message << std::endl;
+}
+
+struct ResolvedOptions {
+    int jobs;
+    int threadsPerJob;
+    BackgroundManifest::OutputParams params;               // primary rendition (ladder[0])
+    std::vector<BackgroundManifest::OutputParams> ladder;  // every rendition, primary first
+    bool keepSources;
+    bool stream;
+    bool fillFrame;  // false for the default ladder, which keeps the plain resize
+};
+
+ResolvedOptions resolveOptions(const VideoStandardizer::Options& options) {
+    int cores = ThreadPolicy::availableCores();
+    ResolvedOptions resolved;
+    // x264 scales well up to ~4 threads per 720p stream; beyond that parallel clips win
+    resolved.jobs = options.jobs > 0 ? options.jobs : std::max(1, cores / 4);
+    resolved.threadsPerJob = options.threadsPerJob > 0
+        ? options.threadsPerJob
+        : std::max(1, cores / resolved.jobs);
+    resolved.ladder = options.ladder;
+    resolved.fillFrame = !resolved.ladder.empty();
+    if (resolved.ladder.empty()) {
+        BackgroundManifest::OutputParams params;
+        params.width = options.width;
+        params.height = options.height;
+        params.fps = options.fps;
+        resolved.ladder.push_back(params);
+    }
+    for (auto& params : resolved.ladder) {
+        params.crf = options.crf;
+        params.gopFrames = options.gopSeconds > 0 ? params.fps * options.gopSeconds : 0;
+    }
+    resolved.ladder = BackgroundManifest::withOverlays(resolved.ladder, options.overlays);
+    resolved.params = resolved.ladder.front();
+    resolved.keepSources = options.keepSources;
+    resolved.stream = options.stream;
+    return resolved;
+}
+
+bool isVideoExtension(std::string ext) {
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".mp4" || ext == ".mov" || ext == ".avi" ||
+           ext == ".mkv" || ext == ".webm";
+}
+
+bool isStandardizedStem(const std::string& stem) {
+    return (stem.size() >= 4 && stem.compare(stem.size() - 4, 4, "_std") == 0) ||
+           BackgroundManifest::isRenditionVariant(stem);
+}
+
+// Accepts local paths as well as URLs (presigned R2 objects); 0 when the duration is
+// unknown, as for fragmented MP4 whose empty moov carries none
+double probeDuration(const std::string& location) {
+    AVFormatContext* ctx = nullptr;
+    double duration = 0.0;
+    if (avformat_open_input(&ctx, location.c_str(), nullptr, nullptr) == 0) {
+        if (avformat_find_stream_info(ctx, nullptr) >= 0 && ctx->duration != AV_NOPTS_VALUE && ctx->duration > 0) {
+            duration = static_cast<double>(ctx->duration) / AV_TIME_BASE;
+        }
+        avformat_close_input(&ctx);
+    }
+    return duration;
+}
+
+// Duration of a standardized clip; renditions keep the source's length, so the source
+// stands in when the output does not report one
+double clipDuration(const std::string& output, const std::string& source) {
+    double duration = probeDuration(output);
+    return duration > 0.0 ? duration : probeDuration(source);
+}
+
+// An explicit ladder fills the target frame and crops the overflow, so a 16:9 source can
+// feed a 9:16 rendition. The default ladder resizes to the frame as it always has.
+std::string renditionFilter(const BackgroundManifest::OutputParams& params, const ResolvedOptions& options) {
+    std::ostringstream filter;
+    filter << "scale=" << params.width << ":" << params.height;
+    if (options.fillFrame) {
+        filter << ":force_original_aspect_ratio=increase,crop=" << params.width << ":" << params.height;
+    }
+    // Square pixels in every rendition: a plain resize of a non-16:9 source would
+    // otherwise keep a SAR that the renderer's concat refuses to join
+    filter << ",fps=" << params.fps << ",setsar=1";
+    if (!params.overlay.empty()) {
+        // Same blend the renderer would otherwise apply to every output frame
+        filter << ",format=yuv420p,drawbox=x=0:y=0:w=iw:h=ih:color=" << params.overlay << ":t=fill";
+    }
+    return filter.str();
+}
+
+// One of `encoders` outputs of the same ffmpeg process, which split the job's threads
+std::string encoderArgs(const BackgroundManifest::OutputParams& params, const ResolvedOptions& options,
+                        int encoders) {
+    std::ostringstream args;
+    args << "-c:v libx264 -preset fast -crf " << params.crf << " "
+         << "-threads " << std::max(1, options.threadsPerJob / std::max(1, encoders)) << " ";
+    if (params.gopFrames > 0) {
+        // Keyframes land exactly every gopFrames, so cuts on GOP boundaries need no re-encode
+        args << "-g " << params.gopFrames << " -keyint_min " << params.gopFrames << " -sc_threshold 0 ";
+    }
+    args << "-pix_fmt yuv420p "
+         << "-an ";  // Remove audio
+    return args.str();
+}
+
+// Decode once and encode every rendition of the ladder; outputs[i] pairs with ladder[i]
+bool transcodeClip(const fs::path& input, const std::vector<fs::path>& outputs, const ResolvedOptions& options) {
+    std::ostringstream graph;
+    if (outputs.size() == 1) {
+        graph << "[0:v]" << renditionFilter(options.ladder[0], options) << "[o0]";
+    } else {
+        graph << "[0:v]split=" << outputs.size();
+        for (size_t i = 0; i < outputs.size(); ++i) graph << "[s" << i << "]";
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            graph << ";[s" << i << "]" << renditionFilter(options.ladder[i], options) << "[o" << i << "]";
+        }
+    }
+
+    std::ostringstream cmd;
+    cmd << "ffmpeg -y -i \"" << input.string() << "\" "
+        << "-filter_complex \"" << graph.str() << "\" ";
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        cmd << "-map \"[o" << i << "]\" "
+            << encoderArgs(options.ladder[i], options, static_cast<int>(outputs.size()))
+            << "-movflags +faststart \"" << outputs[i].string() << "\" ";
+    }
+    cmd << kNullRedirect;
+    int result = std::system(cmd.str().c_str());
+    return result == 0 && std::all_of(outputs.begin(), outputs.end(),
+                                      [](const fs::path& output) { return fs::exists(output); });
+}
+
+// ffmpeg reads the source over HTTP and writes fragmented MP4 to stdout; a
+// fragmented file needs no seek back to write the moov atom, so it can be piped.
+std::string streamingTranscodeCommand(const std::string& inputUrl,
+                                      const BackgroundManifest::OutputParams& params,
+                                      const ResolvedOptions& options) {
+    std::ostringstream cmd;
+    cmd << "ffmpeg -nostdin -i \"" << inputUrl << "\" "
+        << "-vf \"" << renditionFilter(params, options) << "\" "
+        << encoderArgs(params, options, 1)
+        << "-movflags frag_keyframe+empty_moov+default_base_moof "
+        << "-f mp4 pipe:1" << kNullRedirect;
+    return cmd.str();
+}
+
+// Pipe one rendition from the presigned source URL into a multipart upload
+bool streamRendition(R2::Client& r2Client, const std::string& sourceUrl,
+                     const BackgroundManifest::OutputParams& params,
+                     const std::string& key, const ResolvedOptions& options) {
+    std::string command = streamingTranscodeCommand(sourceUrl, params, options);
+    FILE* pipe = QVM_POPEN(command.c_str(), "rb");
+    if (!pipe) return false;
+
+    bool closed = false;
+    auto reader = [&](char* buffer, size_t size) -> size_t {
+        if (closed) return 0;
+        size_t count = std::fread(buffer, 1, size, pipe);
+        if (count == 0) {
+            // Refuse to complete the upload from a truncated encode
+            closed = true;
+            int status = QVM_PCLOSE(pipe);
+            if (status != 0) {
+                throw std::runtime_error("ffmpeg exited with status " + std::to_string(status));
+            }
+        }
+        return count;
+    };
+
+    bool uploaded = r2Client.uploadStream(reader, key);
+    if (!closed) QVM_PCLOSE(pipe);
+    return uploaded;
+}
+
+// One clip moving through the download -> transcode -> upload pipeline
+struct ClipJob {
+    std::string theme;
+    std::string filename;
+    std::string sourceKey;     // R2 key of the original (empty for local runs)
+    fs::path sourcePath;
+    std::vector<fs::path> outputPaths;    // one per ladder rendition, primary first
+    std::vector<std::string> outputKeys;  // R2 keys (or "theme/name" for local runs), same order
+    std::string manifestSource;  // "theme/name.ext"
+    std::string sourceHash;    // empty until hashed (local sources hash in the worker)
+    std::uintmax_t sourceSize = 0;
+    long long sourceModified = 0;
+    double duration = 0.0;
+};
+
+long long modifiedTime(const fs::path& path) {
+    std::error_code ec;
+    auto time = fs::last_write_time(path, ec);
+    return ec ? 0 : static_cast<long long>(time.time_since_epoch().count());
+}
+
+// Derive per-rendition output names; keys are "theme/name", paths live under `directory`
+void assignOutputs(ClipJob& job, const fs::path& directory, const std::string& pathPrefix,
+                   const std::string& sourceStem, const ResolvedOptions& options) {
+    for (size_t i = 0; i < options.ladder.size(); ++i) {
+        std::string filename = BackgroundManifest::outputFilename(sourceStem, options.ladder[i], i == 0);
+        job.outputPaths.push_back(directory / (pathPrefix + filename));
+        job.outputKeys.push_back(job.theme + "/" + filename);
+    }
+}
+
+BackgroundManifest::ClipEntry makeEntry(const ClipJob& job,
+                                        const std::vector<BackgroundManifest::OutputParams>& ladder) {
+    BackgroundManifest::ClipEntry entry;
+    entry.theme = job.theme;
+    entry.source = job.manifestSource;
+    entry.sourceHash = job.sourceHash;
+    entry.sourceSize = job.sourceSize;
+    entry.sourceModified = job.sourceModified;
+    entry.output = job.outputKeys.front();
+    entry.params = ladder.front();
+    for (size_t i = 1; i < ladder.size(); ++i) {
+        entry.renditions.push_back({job.outputKeys[i], ladder[i]});
+    }
+    entry.duration = job.duration;
+    entry.standardizedAt = VideoStandardizer::getCurrentTimestamp();
+    return entry;
+}
+
+// Thread-safe tally of a standardization run, printed once all workers finish.
+// Successful clips are merged into the manifest as they complete.
+class RunReport {
+public:
+    explicit RunReport(BackgroundManifest::Manifest& manifest)
+        : manifest_(manifest), start_(std::chrono::steady_clock::now()) {}
+
+    void addSuccess(const ClipJob& job, uintmax_t sourceBytes, BackgroundManifest::ClipEntry entry) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        manifest_.upsert(std::move(entry));
+        processed_++;
+        totalDuration_ += job.duration;
+        sourceBytes_ += sourceBytes;
+    }
+
+    void addFailure(const ClipJob& job, const std::string& stage, const std::string& reason) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failures_.push_back(job.theme + "/" + job.filename + " [" + stage + "] " + reason);
+    }
+
+    void addSkipped() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        skipped_++;
+    }
+
+    void addStale(const std::string& source) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stale_.push_back(source);
+    }
+
+    void print() const {
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        double safeWall = std::max(wallSeconds, 1e-6);
+        std::cout << "Processed videos: " << processed_ << " (" << totalDuration_ << " seconds)" << std::endl;
+        std::cout << "Unchanged (skipped): " << skipped_ << std::endl;
+        std::cout << "Manifest: " << manifest_.clips().size() << " videos, "
+                  << manifest_.totalDuration() << " seconds" << std::endl;
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Wall time: " << wallSeconds << " seconds" << std::endl
+                  << "Throughput: " << (processed_ * 60.0 / safeWall) << " clips/min, "
+                  << (totalDuration_ / safeWall) << "x realtime, "
+                  << (sourceBytes_ / (1024.0 * 1024.0) / safeWall) << " MB/s source"
+                  << std::defaultfloat << std::endl;
+        if (!stale_.empty()) {
+            std::cerr << "Outdated parameters but source no longer available (" << stale_.size()
+                      << "); rerun with the originals and --standardize-keep-source to refresh:" << std::endl;
+            for (const auto& source : stale_) {
+                std::cerr << "  " << source << std::endl;
+            }
+        }
+        if (!failures_.empty()) {
+            std::cerr << "Failed clips (" << failures_.size() << "):" << std::endl;
+            for (const auto& failure : failures_) {
+                std::cerr << "  " << failure << std::endl;
+            }
+        }
+    }
+
+private:
+    BackgroundManifest::Manifest& manifest_;
+    std::chrono::steady_clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::vector<std::string> failures_;
+    std::vector<std::string> stale_;
+    int processed_ = 0;
+    double totalDuration_ = 0.0;
+    uintmax_t sourceBytes_ = 0;
+    int skipped_ = 0;
+};
+
+// Report manifest entries produced with another ladder whose source is gone
+void collectStaleEntries(const BackgroundManifest::Manifest& manifest,
+                         const std::set<std::string>& existingSources,
+                         const std::vector<BackgroundManifest::OutputParams>& ladder,
+                         RunReport& report) {
+    for (const auto& [key, entry] : manifest.clips()) {
+        if (entry.ladder() == ladder) continue;
+        if (!entry.source.empty() && existingSources.count(entry.source)) continue;
+        report.addStale(entry.source.empty() ? entry.output : entry.source);
+    }
+}
+
+template <typename Fn>
+std::vector<std::thread> startWorkers(int count, Fn fn) {
+    std::vector<std::thread> workers;
+    for (int i = 0; i < count; ++i) {
+        workers.emplace_back(fn);
+    }
+    return workers;
+}
+
+void joinAll(std::vector<std::thread>& workers) {
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+} // namespace
+
 namespace VideoStandardizer {
 
 std::string getCurrentTimestamp() {
@@ -32,113 +380,154 @@ std::string getCurrentTimestamp() {
     return oss.str();
 }
 
-// clean me  up by removing boolean flag and splitting into two functions
-void standardizeDirectory(const std::string& path, bool isR2Bucket) {
-    if (isR2Bucket) {
-        standardizeR2Bucket(path);
-        return;
-    }
-    
+void standardizeDirectory(const std::string& path, const Options& options) {
     if (!fs::exists(path)) {
         throw std::runtime_error("Directory does not exist: " + path);
     }
-    
+
+    ResolvedOptions resolved = resolveOptions(options);
     std::cout << "Standardizing videos in: " << path << std::endl;
-    
-    json metadata;
-    metadata["standardizedAt"] = getCurrentTimestamp();
-    metadata["videos"] = json::array();
-    
-    int totalVideos = 0;
-    double totalDuration = 0.0;
-    
-    // Process each theme directory
-    for (const auto& themeEntry : fs::directory_iterator(path)) {
-        if (!themeEntry.is_directory()) continue;
-        
-        std::string theme = themeEntry.path().filename().string();
-        std::cout << "\nProcessing theme: " << theme << std::endl;
-        
-        for (const auto& videoEntry : fs::directory_iterator(themeEntry)) {
-            if (!videoEntry.is_regular_file()) continue;
-            
-            std::string ext = videoEntry.path().extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-            
-            if (ext != ".mp4" && ext != ".mov" && ext != ".avi" && 
-                ext != ".mkv" && ext != ".webm") continue;
-            
-            // Skip already standardized files
-            auto stem = videoEntry.path().stem().string();
-            // (s.size() >= 4 && s.compare(s.size() - 4, 4, "_std") == 0)
-            if (stem.size() >= 4 && stem.compare(stem.size() - 4, 4, "_std") == 0){
-                std::cout << "  Already standardized: " << videoEntry.path().filename() << std::endl;
+    std::cout << "Workers: " << resolved.jobs << " jobs x " << resolved.threadsPerJob << " threads" << std::endl;
+
+    fs::path metadataPath = fs::path(path) / "metadata.json";
+    BackgroundManifest::Manifest manifest = BackgroundManifest::Manifest::load(metadataPath);
+    RunReport report(manifest);
+
+    Concurrency::BoundedQueue<ClipJob> transcodeQueue(resolved.jobs * 2);
+    auto transcoders = startWorkers(resolved.jobs, [&]() {
+        while (auto job = transcodeQueue.pop()) {
+            if (job->sourceHash.empty()) {
+                try {
+                    job->sourceHash = CacheUtils::hashFile(job->sourcePath);
+                } catch (const std::exception& e) {
+                    report.addFailure(*job, "hash", e.what());
+                    continue;
+                }
+            }
+            logLine("  Standardizing: " + job->theme + "/" + job->filename + " -> " +
+                    job->outputPaths.front().filename().string());
+            if (!transcodeClip(job->sourcePath, job->outputPaths, resolved)) {
+                logLine("  Failed to standardize: " + job->filename, true);
+                report.addFailure(*job, "transcode", "ffmpeg failed");
                 continue;
             }
-            
-            // Standardize the video
-            fs::path outputPath = videoEntry.path().parent_path() / 
-                                  (videoEntry.path().stem().string() + "_std.mp4");
-            
-            std::ostringstream cmd;
-            cmd << "ffmpeg -y -i \"" << videoEntry.path().string() << "\" "
-                << "-c:v libx264 -preset fast -crf 23 "
-                << "-s 1280x720 -r 30 "
-                << "-pix_fmt yuv420p "
-                << "-an "  // Remove audio
-                << "-movflags +faststart "
-                << "\"" << outputPath.string() << "\" 2>/dev/null";
-            
-            std::cout << "  Standardizing: " << videoEntry.path().filename() << " -> " 
-                      << outputPath.filename() << std::endl;
-            
-            int result = std::system(cmd.str().c_str());
-            if (result == 0 && fs::exists(outputPath)) {
-                // Get duration
-                AVFormatContext* ctx = nullptr;
-                double duration = 0.0;
-                if (avformat_open_input(&ctx, outputPath.string().c_str(), nullptr, nullptr) == 0) {
-                    if (avformat_find_stream_info(ctx, nullptr) >= 0) {
-                        duration = static_cast<double>(ctx->duration) / AV_TIME_BASE;
+            job->duration = clipDuration(job->outputPaths.front().string(), job->sourcePath.string());
+
+            if (!resolved.keepSources) {
+                std::error_code ec;
+                fs::remove(job->sourcePath, ec);
+            }
+
+            report.addSuccess(*job, job->sourceSize, makeEntry(*job, resolved.ladder));
+        }
+    });
+
+    std::vector<std::string> existingOutputs;
+    std::set<std::string> existingSources;
+    bool listingComplete = false;
+
+    // The workers must be joined before leaving, so nothing below may throw past them
+    try {
+        // Process each theme directory
+        for (const auto& themeEntry : fs::directory_iterator(path)) {
+            if (!themeEntry.is_directory()) continue;
+
+            std::string theme = themeEntry.path().filename().string();
+            std::vector<fs::path> sources;
+
+            for (const auto& videoEntry : fs::directory_iterator(themeEntry)) {
+                if (!videoEntry.is_regular_file()) continue;
+                if (!isVideoExtension(videoEntry.path().extension().string())) continue;
+
+                std::string relative = theme + "/" + videoEntry.path().filename().string();
+                if (!isStandardizedStem(videoEntry.path().stem().string())) {
+                    sources.push_back(videoEntry.path());
+                    continue;
+                }
+
+                existingOutputs.push_back(relative);
+                // Adopt clips standardized before the manifest existed (same defaults as today)
+                if (!BackgroundManifest::isRenditionVariant(videoEntry.path().stem().string()) &&
+                    !manifest.findByOutput(relative)) {
+                    BackgroundManifest::ClipEntry adopted;
+                    adopted.theme = theme;
+                    adopted.output = relative;
+                    adopted.duration = probeDuration(videoEntry.path().string());
+                    if (adopted.duration <= 0.0) logLine("  Duration unknown: " + relative, true);
+                    adopted.standardizedAt = getCurrentTimestamp();
+                    manifest.upsert(std::move(adopted));
+                }
+            }
+
+            for (const auto& sourcePath : sources) {
+                ClipJob job;
+                job.theme = theme;
+                job.filename = sourcePath.filename().string();
+                job.manifestSource = theme + "/" + job.filename;
+                job.sourcePath = sourcePath;
+                assignOutputs(job, sourcePath.parent_path(), "", sourcePath.stem().string(), resolved);
+                std::error_code ec;
+                job.sourceSize = fs::file_size(sourcePath, ec);
+                job.sourceModified = modifiedTime(sourcePath);
+                existingSources.insert(job.manifestSource);
+
+                const auto* prior = manifest.findBySource(job.manifestSource);
+                if (prior) {
+                    // Size and mtime unchanged means the stored hash is still valid
+                    if (prior->sourceSize == job.sourceSize && prior->sourceModified == job.sourceModified) {
+                        job.sourceHash = prior->sourceHash;
+                    } else {
+                        try {
+                            job.sourceHash = CacheUtils::hashFile(sourcePath);
+                        } catch (const std::exception& e) {
+                            report.addFailure(job, "hash", e.what());
+                            continue;
+                        }
+                    }
+                    bool outputsPresent = std::all_of(job.outputPaths.begin(), job.outputPaths.end(),
+                                                      [](const fs::path& output) { return fs::exists(output); });
+                    if (job.sourceHash == prior->sourceHash && prior->ladder() == resolved.ladder && outputsPresent) {
+                        report.addSkipped();
+                        continue;
                     }
-                    avformat_close_input(&ctx);
                 }
-                
-                // Remove original
-                fs::remove(videoEntry.path());
-                
-                // Add to metadata
-                json videoInfo;
-                videoInfo["theme"] = theme;
-                videoInfo["filename"] = outputPath.filename().string();
-                videoInfo["duration"] = duration;
-                metadata["videos"].push_back(videoInfo);
-                
-                totalVideos++;
-                totalDuration += duration;
-            } else {
-                std::cerr << "  Failed to standardize: " << videoEntry.path().filename() << std::endl;
+
+                logLine("  Queued: " + job.manifestSource + (prior ? " (changed)" : " (new)"));
+                transcodeQueue.push(std::move(job));
             }
         }
+        listingComplete = true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error during standardization: " << e.what() << std::endl;
     }
-    
-    metadata["totalVideos"] = totalVideos;
-    metadata["totalDuration"] = totalDuration;
-    
-    // Save metadata
-    fs::path metadataPath = fs::path(path) / "metadata.json";
-    std::ofstream metaFile(metadataPath);
-    metaFile << metadata.dump(2);
-    
+
+    transcodeQueue.close();
+    joinAll(transcoders);
+
+    // Only prune against a complete listing; a partial one would drop valid entries
+    size_t pruned = 0;
+    if (listingComplete) {
+        // Outputs written during this run are on disk now as well
+        existingOutputs.clear();
+        for (const auto& [key, entry] : manifest.clips()) {
+            if (fs::exists(fs::path(path) / entry.output)) existingOutputs.push_back(entry.output);
+        }
+        pruned = manifest.prune(existingOutputs,
+                                std::vector<std::string>(existingSources.begin(), existingSources.end()));
+        collectStaleEntries(manifest, existingSources, resolved.ladder, report);
+    }
+    manifest.standardizedAt = getCurrentTimestamp();
+    manifest.save(metadataPath);
+
     std::cout << "\n✅ Standardization complete!" << std::endl;
-    std::cout << "Total videos: " << totalVideos << std::endl;
-    std::cout << "Total duration: " << totalDuration << " seconds" << std::endl;
+    report.print();
+    if (pruned > 0) std::cout << "Removed " << pruned << " manifest entries for deleted clips" << std::endl;
     std::cout << "Metadata saved to: " << metadataPath << std::endl;
 }
 
-void standardizeR2Bucket(const std::string& bucketName) {
+void standardizeR2Bucket(const std::string& bucketName, const Options& options) {
     std::cout << "Standardizing R2 bucket: " << bucketName << std::endl;
-    
+
     // Get R2 config from environment
     R2::R2Config r2Config;
     r2Config.bucket = bucketName;
@@ -146,132 +535,243 @@ void standardizeR2Bucket(const std::string& bucketName) {
     r2Config.accessKey = std::getenv("R2_ACCESS_KEY") ? std::getenv("R2_ACCESS_KEY") : "";
     r2Config.secretKey = std::getenv("R2_SECRET_KEY") ? std::getenv("R2_SECRET_KEY") : "";
     r2Config.usePublicAccess = false;
-    
+
     if (r2Config.endpoint.empty() || r2Config.accessKey.empty() || r2Config.secretKey.empty()) {
         throw std::runtime_error("R2 credentials not set. Please set R2_ENDPOINT, R2_ACCESS_KEY, and R2_SECRET_KEY environment variables.");
     }
-    
+
+    ResolvedOptions resolved = resolveOptions(options);
+    std::cout << "Workers: " << resolved.jobs << " jobs x " << resolved.threadsPerJob << " threads" << std::endl;
+
     R2::Client r2Client(r2Config);
-    
+
     // Create temp directory for processing
     fs::path tempDir = fs::temp_directory_path() / ("r2_standardize_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
     fs::create_directories(tempDir);
-    
-    json metadata;
-    metadata["bucket"] = bucketName;
-    metadata["standardizedAt"] = getCurrentTimestamp();
-    metadata["videos"] = json::array();
-    
-    int totalVideos = 0;
-    double totalDuration = 0.0;
-    
-    try {
-        // List all themes
-        auto themes = r2Client.listThemes();
-        
-        for (const auto& theme : themes) {
-            std::cout << "\nProcessing theme: " << theme << std::endl;
-            
-            // List videos in theme
-            auto videos = r2Client.listVideosInTheme(theme);
-            
-            for (const auto& videoKey : videos) {
-                std::string filename = fs::path(videoKey).filename().string();
-                
-                // Skip already standardized files
-                if (filename.find("_std.mp4") != std::string::npos) {
-                    std::cout << "  Already standardized: " << filename << std::endl;
+
+    // Merge into the manifest from previous runs instead of starting over
+    BackgroundManifest::Manifest manifest;
+    fs::path metadataPath = tempDir / "metadata.json";
+    if (r2Client.objectExists("metadata.json")) {
+        try {
+            r2Client.downloadVideo("metadata.json", metadataPath);
+            manifest = BackgroundManifest::Manifest::load(metadataPath);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Could not load existing manifest: " << e.what() << std::endl;
+        }
+    }
+    manifest.bucket = bucketName;
+    RunReport report(manifest);
+
+    // libavformat probes adopted clips (and, when streaming, outputs) over HTTPS
+    avformat_network_init();
+    if (resolved.stream) {
+        std::cout << "Streaming mode: sources and outputs are piped, nothing is staged on disk" << std::endl;
+    }
+
+    // Downloads and uploads overlap with transcodes of other clips. The queue
+    // capacities bound how many downloaded-but-unprocessed clips sit on disk.
+    Concurrency::BoundedQueue<ClipJob> downloadQueue(resolved.jobs * 2);
+    Concurrency::BoundedQueue<ClipJob> transcodeQueue(resolved.jobs);
+    Concurrency::BoundedQueue<ClipJob> uploadQueue(resolved.jobs);
+
+    // Outputs uploaded during this run are not in the listing taken before it
+    std::mutex uploadedMutex;
+    std::vector<std::string> uploadedKeys;
+
+    auto finishUpload = [&](const ClipJob& job) {
+        if (!resolved.keepSources) {
+            r2Client.deleteObject(job.sourceKey);
+        }
+        report.addSuccess(job, job.sourceSize, makeEntry(job, resolved.ladder));
+        std::lock_guard<std::mutex> lock(uploadedMutex);
+        uploadedKeys.insert(uploadedKeys.end(), job.outputKeys.begin(), job.outputKeys.end());
+    };
+
+    std::vector<std::thread> downloaders;
+    std::vector<std::thread> transcoders;
+    std::vector<std::thread> uploaders;
+
+    if (resolved.stream) {
+        // Each worker pipes one clip end to end: no scratch files, so the
+        // download queue is the only stage.
+        downloaders = startWorkers(resolved.jobs, [&]() {
+            while (auto job = downloadQueue.pop()) {
+                logLine("  Streaming: " + job->sourceKey + " -> " + job->outputKeys.front());
+                // One ffmpeg per rendition: stdout can only carry a single output, so the
+                // source is fetched and decoded once per rendition. The primary goes last
+                // so it only appears once the whole ladder exists.
+                std::string sourceUrl = r2Client.presignedGetUrl(job->sourceKey);
+                bool uploaded = true;
+                for (size_t i = job->outputKeys.size(); i-- > 0 && uploaded;) {
+                    uploaded = streamRendition(r2Client, sourceUrl, resolved.ladder[i], job->outputKeys[i], resolved);
+                }
+                if (!uploaded) {
+                    report.addFailure(*job, "stream", "transcode or multipart upload failed");
                     continue;
                 }
-                
-                // Download video
-                fs::path localPath = tempDir / filename;
-                std::cout << "  Downloading: " << filename << std::endl;
-                
+
+                job->duration = clipDuration(r2Client.presignedGetUrl(job->outputKeys.front()), sourceUrl);
+                finishUpload(*job);
+            }
+        });
+    } else {
+        downloaders = startWorkers(resolved.jobs, [&]() {
+            while (auto job = downloadQueue.pop()) {
+                logLine("  Downloading: " + job->sourceKey);
                 try {
-                    r2Client.downloadVideo(videoKey, localPath);
+                    r2Client.downloadVideo(job->sourceKey, job->sourcePath);
                 } catch (const std::exception& e) {
-                    std::cerr << "  Download failed: " << e.what() << std::endl;
+                    logLine(std::string("  Download failed: ") + e.what(), true);
+                    report.addFailure(*job, "download", e.what());
                     continue;
                 }
-                
-                // Standardize the video
-                std::string stdFilename = fs::path(filename).stem().string() + "_std.mp4";
-                fs::path stdPath = tempDir / stdFilename;
-                
-                std::ostringstream cmd;
-                cmd << "ffmpeg -y -i \"" << localPath.string() << "\" "
-                    << "-c:v libx264 -preset fast -crf 23 "
-                    << "-s 1280x720 -r 30 "
-                    << "-pix_fmt yuv420p "
-                    << "-an "  // Remove audio
-                    << "-movflags +faststart "
-                    << "\"" << stdPath.string() << "\" 2>/dev/null";
-                
-                std::cout << "  Standardizing: " << filename << " -> " << stdFilename << std::endl;
-                
-                int result = std::system(cmd.str().c_str());
-                if (result == 0 && fs::exists(stdPath)) {
-                    // Get duration
-                    AVFormatContext* ctx = nullptr;
-                    double duration = 0.0;
-                    if (avformat_open_input(&ctx, stdPath.string().c_str(), nullptr, nullptr) == 0) {
-                        if (avformat_find_stream_info(ctx, nullptr) >= 0) {
-                            duration = static_cast<double>(ctx->duration) / AV_TIME_BASE;
-                        }
-                        avformat_close_input(&ctx);
-                    }
-                    
-                    // Upload standardized video
-                    std::string newKey = theme + "/" + stdFilename;
-                    std::cout << "  Uploading: " << newKey << std::endl;
-                    
-                    if (r2Client.uploadVideo(stdPath, newKey)) {
-                        // Delete original from R2
-                        r2Client.deleteObject(videoKey);
-                        
-                        // Add to metadata
-                        json videoInfo;
-                        videoInfo["theme"] = theme;
-                        videoInfo["filename"] = stdFilename;
-                        videoInfo["key"] = newKey;
-                        videoInfo["duration"] = duration;
-                        metadata["videos"].push_back(videoInfo);
-                        
-                        totalVideos++;
-                        totalDuration += duration;
-                    }
-                    
-                    // Clean up local files
-                    fs::remove(localPath);
-                    fs::remove(stdPath);
+                transcodeQueue.push(std::move(*job));
+            }
+        });
+
+        transcoders = startWorkers(resolved.jobs, [&]() {
+            while (auto job = transcodeQueue.pop()) {
+                logLine("  Standardizing: " + job->filename + " -> " + job->outputKeys.front());
+                bool ok = transcodeClip(job->sourcePath, job->outputPaths, resolved);
+                if (!ok) {
+                    logLine("  Failed to standardize: " + job->filename, true);
+                    report.addFailure(*job, "transcode", "ffmpeg failed");
+                    std::error_code ec;
+                    fs::remove(job->sourcePath, ec);
+                    for (const auto& output : job->outputPaths) fs::remove(output, ec);
+                    continue;
+                }
+                job->duration = clipDuration(job->outputPaths.front().string(), job->sourcePath.string());
+                uploadQueue.push(std::move(*job));
+            }
+        });
+
+        uploaders = startWorkers(resolved.jobs, [&]() {
+            while (auto job = uploadQueue.pop()) {
+                logLine("  Uploading: " + job->outputKeys.front());
+                // Primary last, matching the streaming path
+                bool uploaded = true;
+                for (size_t i = job->outputKeys.size(); i-- > 0 && uploaded;) {
+                    uploaded = r2Client.uploadVideo(job->outputPaths[i], job->outputKeys[i]);
+                }
+                if (uploaded) {
+                    finishUpload(*job);
                 } else {
-                    std::cerr << "  Failed to standardize: " << filename << std::endl;
+                    report.addFailure(*job, "upload", "PutObject failed");
                 }
+
+                // Clean up local files
+                std::error_code ec;
+                fs::remove(job->sourcePath, ec);
+                for (const auto& output : job->outputPaths) fs::remove(output, ec);
+            }
+        });
+    }
+
+    std::vector<std::string> existingOutputs;
+    std::set<std::string> existingSources;
+    bool listingComplete = false;
+
+    try {
+        // List all themes
+        auto themes = r2Client.listThemes();
+
+        for (const auto& theme : themes) {
+            // ETags and sizes from the listing are enough to detect changes without downloading
+            std::vector<R2::ObjectInfo> sources;
+            std::set<std::string> themeKeys;
+            for (const auto& object : r2Client.listObjects(theme + "/")) {
+                fs::path keyPath(object.key);
+                if (!isVideoExtension(keyPath.extension().string())) continue;
+                themeKeys.insert(object.key);
+                if (!isStandardizedStem(keyPath.stem().string())) {
+                    sources.push_back(object);
+                    continue;
+                }
+                existingOutputs.push_back(object.key);
+                // Extra renditions are only reachable through their clip's manifest entry
+                if (!BackgroundManifest::isRenditionVariant(keyPath.stem().string()) &&
+                    !manifest.findByOutput(object.key)) {
+                    BackgroundManifest::ClipEntry adopted;
+                    adopted.theme = theme;
+                    adopted.output = object.key;
+                    // libavformat reads the header and a few packets, not the whole clip
+                    adopted.duration = probeDuration(r2Client.presignedGetUrl(object.key));
+                    if (adopted.duration <= 0.0) logLine("  Duration unknown: " + object.key, true);
+                    adopted.standardizedAt = getCurrentTimestamp();
+                    manifest.upsert(std::move(adopted));
+                }
+            }
+
+            for (size_t i = 0; i < sources.size(); ++i) {
+                const auto& object = sources[i];
+                std::string filename = fs::path(object.key).filename().string();
+                existingSources.insert(object.key);
+
+                // Prefix temp names so equal filenames from different themes don't collide
+                std::string tempPrefix = theme + "_" + std::to_string(i) + "_";
+
+                ClipJob job;
+                job.theme = theme;
+                job.filename = filename;
+                job.sourceKey = object.key;
+                job.manifestSource = object.key;
+                job.sourceHash = object.etag;
+                job.sourceSize = static_cast<std::uintmax_t>(object.size);
+                job.sourcePath = tempDir / (tempPrefix + filename);
+                assignOutputs(job, tempDir, tempPrefix, fs::path(filename).stem().string(), resolved);
+
+                const auto* prior = manifest.findBySource(object.key);
+                bool outputsPresent = std::all_of(job.outputKeys.begin(), job.outputKeys.end(),
+                                                  [&](const std::string& key) { return themeKeys.count(key) > 0; });
+                if (prior && prior->sourceHash == object.etag && prior->ladder() == resolved.ladder &&
+                    outputsPresent) {
+                    report.addSkipped();
+                    continue;
+                }
+
+                logLine("  Queued: " + object.key + (prior ? " (changed)" : " (new)"));
+                downloadQueue.push(std::move(job));
             }
         }
-        
-        metadata["totalVideos"] = totalVideos;
-        metadata["totalDuration"] = totalDuration;
-        
+        listingComplete = true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error during R2 standardization: " << e.what() << std::endl;
+    }
+
+    downloadQueue.close();
+    joinAll(downloaders);
+    transcodeQueue.close();
+    joinAll(transcoders);
+    uploadQueue.close();
+    joinAll(uploaders);
+
+    try {
+        // Only prune against a complete listing; a partial one would drop valid entries
+        size_t pruned = 0;
+        if (listingComplete) {
+            std::lock_guard<std::mutex> lock(uploadedMutex);
+            existingOutputs.insert(existingOutputs.end(), uploadedKeys.begin(), uploadedKeys.end());
+            pruned = manifest.prune(existingOutputs,
+                                    std::vector<std::string>(existingSources.begin(), existingSources.end()));
+            collectStaleEntries(manifest, existingSources, resolved.ladder, report);
+        }
+        manifest.standardizedAt = getCurrentTimestamp();
+        manifest.save(metadataPath);
+
         // Upload metadata to R2
-        fs::path metadataPath = tempDir / "metadata.json";
-        std::ofstream metaFile(metadataPath);
-        metaFile << metadata.dump(2);
-        metaFile.close();
-        
         r2Client.uploadVideo(metadataPath, "metadata.json");
-        
+
         std::cout << "\n✅ R2 bucket standardization complete!" << std::endl;
-        std::cout << "Total videos: " << totalVideos << std::endl;
-        std::cout << "Total duration: " << totalDuration << " seconds" << std::endl;
-        
+        report.print();
+        if (pruned > 0) std::cout << "Removed " << pruned << " manifest entries for deleted clips" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Error during R2 standardization: " << e.what() << std::endl;
     }
-    
+
     // Clean up temp directory
     fs::remove_all(tempDir);
 }
 
-} // namespace VideoStandardizer
\ No newline at end of file
+} // namespace VideoStandardizer
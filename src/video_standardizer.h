@@ -1,8 +1,35 @@
 #pragma once
+#include "background_manifest.h"
 #include <string>
+#include <vector>
 
 namespace VideoStandardizer {
-    void standardizeDirectory(const std::string& path, bool isR2Bucket = false);
-    void standardizeR2Bucket(const std::string& bucketName);
+    struct Options {
+        int jobs = 0;           // concurrent transcodes (0 = derive from core count)
+        int threadsPerJob = 0;  // ffmpeg threads per transcode (0 = cores / jobs)
+
+        // Output parameters recorded in the manifest; changing them re-standardizes clips
+        int width = 1280;
+        int height = 720;
+        int fps = 30;
+        int crf = 23;
+        int gopSeconds = 1;  // fixed keyframe interval so clips can be cut and concatenated without re-encoding
+
+        // Sizes to produce per clip, primary first (named *_std.mp4). Empty means a
+        // single width x height @ fps rendition. crf applies to every rendition.
+        std::vector<BackgroundManifest::OutputParams> ladder;
+
+        // Overlay colors to bake into extra pre-dimmed copies of every rendition
+        std::vector<std::string> overlays;
+
+        // Keep originals so later parameter changes can be re-applied from the source
+        bool keepSources = false;
+
+        // R2 only: pipe GetObject -> ffmpeg -> multipart upload instead of staging temp files
+        bool stream = false;
+    };
+
+    void standardizeDirectory(const std::string& path, const Options& options = {});
+    void standardizeR2Bucket(const std::string& bucketName, const Options& options = {});
     std::string getCurrentTimestamp();
-}
\ No newline at end of file
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include "interfaces/IProcessExecutor.h"
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 #include <string>
 
@@ -14,10 +16,30 @@ public:
         commands.push_back(command);
     }
 
+    int executeStreaming(const std::string& command,
+                         const std::function<void(const Interfaces::OutputReader&)>& consume) override {
+        commands.push_back(command);
+        size_t offset = 0;
+        consume([&](char* buffer, size_t size) {
+            size_t count = std::min(size, streamOutput.size() - offset);
+            std::copy(streamOutput.data() + offset, streamOutput.data() + offset + count, buffer);
+            offset += count;
+            // Same contract as the real executor: a failed command throws at end of output
+            if (count == 0 && streamExitCode != 0) throw std::runtime_error("command failed");
+            return count;
+        });
+        return streamExitCode;
+    }
+
     const std::vector<std::string>& getCommands() const {
         return commands;
     }
 
+    // Bytes executeStreaming() presents as the command's stdout
+    std::string streamOutput;
+    // Exit code of the streamed command
+    int streamExitCode = 0;
+
 private:
     std::vector<std::string> commands;
 };
@@ -0,0 +1,29 @@
+#pragma once
+#include "interfaces/IStreamUploader.h"
+#include <exception>
+#include <string>
+
+class MockStreamUploader : public Interfaces::IStreamUploader {
+public:
+    bool upload(const Interfaces::OutputReader& reader, const std::string& key) override {
+        this->key = key;
+        char buffer[4096];
+        size_t count;
+        try {
+            while ((count = reader(buffer, sizeof(buffer))) > 0) {
+                received.append(buffer, count);
+            }
+        } catch (const std::exception&) {
+            aborted = true;
+            return false;
+        }
+        published = succeed;
+        return succeed;
+    }
+
+    std::string key;
+    std::string received;
+    bool succeed = true;
+    bool published = false;  // what the key would hold was made visible
+    bool aborted = false;
+};
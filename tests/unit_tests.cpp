@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -13,8 +14,18 @@
 #include "audio/custom_audio_processor.h"
 #include "video_generator.h"
 #include "metadata_writer.h"
+#include "video_selector.h"
+#include "background_manifest.h"
+#include "render_cache.h"
+#include "verse_index.h"
+#include "text_layers.h"
+#include "thread_policy.h"
+#include "render_history.h"
+#include "deadline_planner.h"
+#include "encoder_backends.h"
 #include "MockApiClient.h"
 #include "MockProcessExecutor.h"
+#include "MockStreamUploader.h"
 #include <memory>
 #include <nlohmann/json.hpp>
 
@@ -38,6 +49,22 @@ fs::path getProjectRoot() {
     return root;
 }
 
+// Render of 1:1 into <temp>/outputName with caching off; tests set the rest before loading
+CLIOptions makeRenderOptions(const std::string& outputName) {
+    CLIOptions opts;
+    opts.surah = 1;
+    opts.from = 1;
+    opts.to = 1;
+    opts.noCache = true;
+    opts.output = (fs::temp_directory_path() / outputName).string();
+    return opts;
+}
+
+// The project's config.json; quality profiles may adjust opts (e.g. the encoder)
+AppConfig loadTestConfig(CLIOptions& opts) {
+    return loadConfig((getProjectRoot() / "config.json").string(), opts);
+}
+
 void testConfigLoader() {
     CLIOptions opts;
     AppConfig cfg = loadConfig((getProjectRoot() / "config.json").string(), opts);
@@ -110,6 +137,30 @@ void testSubtitleBuilder() {
     std::vector<VerseData> verses = {makeSampleVerse()};
     std::string assPath = SubtitleBuilder::buildAssFile(cfg, opts, verses, cfg.introDuration, cfg.pauseAfterIntroDuration);
     assert(fs::exists(assPath));
+
+    auto readAll = [](const std::string& path) {
+        std::ifstream file(path);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    };
+    std::string arabic = readAll(SubtitleBuilder::buildAssFile(cfg, opts, verses, cfg.introDuration, cfg.pauseAfterIntroDuration,
+                                                               nullptr, "subtitles_arabic_test.ass", SubtitleBuilder::Layers::Arabic));
+    std::string translation = readAll(SubtitleBuilder::buildAssFile(cfg, opts, verses, cfg.introDuration, cfg.pauseAfterIntroDuration,
+                                                                    nullptr, "subtitles_translation_test.ass", SubtitleBuilder::Layers::Translation));
+    assert(arabic.find("\\rArabic") != std::string::npos && arabic.find("\\rTranslation") == std::string::npos);
+    assert(translation.find("\\rTranslation") != std::string::npos && translation.find("\\rArabic") == std::string::npos);
+    assert(translation.find("In the name of Allah") != std::string::npos);
+
+    // The burned-in Arabic does not move or change with the translation it ships with
+    AppConfig otherCfg = cfg;
+    otherCfg.translationFont.family = "Other Translation Font";
+    std::vector<VerseData> otherVerses = verses;
+    otherVerses[0].translation = std::string(700, 'x');
+    std::string otherArabic = readAll(SubtitleBuilder::buildAssFile(otherCfg, opts, otherVerses, cfg.introDuration,
+                                                                    cfg.pauseAfterIntroDuration, nullptr,
+                                                                    "subtitles_arabic_other_test.ass",
+                                                                    SubtitleBuilder::Layers::Arabic));
+    assert(otherArabic == arabic);
+    assert(arabic.find("Style: Translation") == std::string::npos);
 }
 
 void testTextLayoutEngine() {
@@ -195,12 +246,9 @@ void testMetadataWriter() {
 }
 
 void testVideoGenerator() {
-    CLIOptions opts;
-    opts.surah = 1;
-    opts.from = 1;
-    opts.to = 1;
-    opts.output = (fs::temp_directory_path() / "test_video.mp4").string();
-    AppConfig cfg = loadConfig((getProjectRoot() / "config.json").string(), opts);
+    CLIOptions opts = makeRenderOptions("test_video.mp4");
+    opts.noCache = false;  // covers the audio track cache
+    AppConfig cfg = loadTestConfig(opts);
     std::vector<VerseData> verses = {makeSampleVerse()};
     std::string dummyAudioPath = (fs::temp_directory_path() / "dummy.wav").string();
     std::ofstream dummyAudio(dummyAudioPath, std::ios::binary);
@@ -225,18 +273,696 @@ void testVideoGenerator() {
     VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor);
     VideoGenerator::generateThumbnail(opts, cfg, mockProcessExecutor);
 
+    // Audio track encode, render (audio re-encoded since the mock wrote no track), thumbnail
     const auto& commands = mockProcessExecutor->getCommands();
-    assert(commands.size() == 2);
-    assert(commands[0].find("ffmpeg") != std::string::npos);
-    assert(commands[0].find(opts.output) != std::string::npos);
+    assert(commands.size() == 3);
+    assert(commands[0].find(".partial.m4a") != std::string::npos);
+    assert(commands[0].find("first_pts=0") != std::string::npos);
     assert(commands[1].find("ffmpeg") != std::string::npos);
+    assert(commands[1].find(opts.output) != std::string::npos);
+    assert(commands[1].find("-c:a aac") != std::string::npos);
+    assert(commands[2].find("ffmpeg") != std::string::npos);
     std::string thumbPath = (fs::path(opts.output).parent_path() / "thumbnail.jpeg").string();
-    assert(commands[1].find(thumbPath) != std::string::npos);
+    assert(commands[2].find(thumbPath) != std::string::npos);
 
     fs::remove(opts.output);
     fs::remove(dummyAudioPath);
 }
 
+void testOpeningSegment() {
+    CLIOptions opts = makeRenderOptions("test_opening.mp4");
+    opts.noCache = false;  // covers the opening cache
+    AppConfig cfg = loadTestConfig(opts);
+    cfg.introDuration = 2.0;
+    std::vector<VerseData> verses = {makeSampleVerse()};
+    verses[0].durationInSeconds = 5.0;
+
+    // The mock never writes the opening, so the render falls back to a single pass
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::EncodeStats stats;
+    VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor, nullptr, nullptr, &stats);
+    const auto& commands = mockProcessExecutor->getCommands();
+    assert(commands.size() == 3);
+    assert(commands[1].find("trim=end=2.5") != std::string::npos);
+    assert(commands[1].find("-an") != std::string::npos);
+    assert(commands[1].find(opts.output) == std::string::npos);
+    assert(commands[2].find(opts.output) != std::string::npos);
+    assert(commands[2].find("trim=") == std::string::npos);
+
+    opts.noCache = true;
+    auto uncachedExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::EncodeStats uncachedStats;
+    VideoGenerator::generateVideo(opts, cfg, verses, uncachedExecutor, nullptr, nullptr, &uncachedStats);
+    assert(uncachedExecutor->getCommands().size() == 1);
+    assert(uncachedExecutor->getCommands()[0].find("trim=") == std::string::npos);
+
+    // The failed opening encode is not timed; both renders timed one full single pass
+    assert(uncachedStats.videoSeconds > 0.0);
+    assert(stats.videoSeconds == uncachedStats.videoSeconds);
+}
+
+void testRenditions() {
+    auto variants = VideoGenerator::parseRenditions("1280x720, 1080x1920:30");
+    assert(variants.size() == 2);
+    assert(variants[0].width == 1280 && variants[0].height == 720 && variants[0].crf == -1);
+    assert(variants[1].width == 1080 && variants[1].height == 1920 && variants[1].crf == 30);
+    bool threw = false;
+    try { VideoGenerator::parseRenditions("1279x720"); } catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+    assert(VideoGenerator::variantOutputPath("out/video.mp4", variants[1]) == fs::path("out/video_1080x1920_crf30.mp4"));
+
+    CLIOptions opts = makeRenderOptions("test_renditions.mp4");
+    opts.variants = variants;
+    AppConfig cfg = loadTestConfig(opts);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor);
+    const auto& commands = mockProcessExecutor->getCommands();
+    assert(commands.size() == 1);
+    assert(commands[0].find("split=3") != std::string::npos);
+    assert(commands[0].find("crop=1080:1920") != std::string::npos);
+    assert(commands[0].find("subtitles_1080x1920.ass") != std::string::npos);
+    assert(commands[0].find(VideoGenerator::variantOutputPath(opts.output, variants[0]).string()) != std::string::npos);
+    assert(commands[0].find("-crf 30") != std::string::npos);
+}
+
+void testTranslationVariants() {
+    auto variants = VideoGenerator::parseTranslations("20, 85,20");
+    assert(variants.size() == 2);
+    assert(variants[0].translationId == 20 && variants[0].width == 0);
+    assert(variants[1].translationId == 85);
+    assert(VideoGenerator::variantOutputPath("out/video.mp4", variants[1]) == fs::path("out/video_t85.mp4"));
+
+    CLIOptions opts = makeRenderOptions("test_translations.mp4");
+    opts.configPath = (getProjectRoot() / "config.json").string();
+    AppConfig cfg = loadTestConfig(opts);
+    AppConfig translated = withTranslation(cfg, opts, 85);
+    assert(translated.translationId == 85);
+    assert(translated.width == cfg.width && translated.arabicFont.file == cfg.arabicFont.file);
+
+    // One decode, no scaling, one subtitle track per language
+    opts.variants = {variants[1]};
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    std::vector<VerseData> verses = {makeSampleVerse()};
+    VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor);
+    const auto& commands = mockProcessExecutor->getCommands();
+    assert(commands.size() == 1);
+    assert(commands[0].find("split=2") != std::string::npos);
+    assert(commands[0].find("[b1]null") != std::string::npos);
+    assert(commands[0].find("subtitles_t85.ass") != std::string::npos);
+    assert(commands[0].find(VideoGenerator::variantOutputPath(opts.output, variants[1]).string()) != std::string::npos);
+}
+
+void testSoftSubtitles() {
+    CLIOptions opts = makeRenderOptions("test_soft.mp4");
+    opts.softSubtitles = true;
+    AppConfig cfg = loadTestConfig(opts);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+
+    // Picture with the Arabic layer burned in, then a stream-copy remux with the translation track
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::EncodeStats stats;
+    VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor, nullptr, nullptr, &stats);
+    const auto& commands = mockProcessExecutor->getCommands();
+    assert(commands.size() == 2);
+    // Soft-subtitle renders stay out of the render history
+    assert(stats.videoSeconds == 0.0);
+    assert(commands[0].find("qvm_picture.mkv") != std::string::npos);
+    assert(commands[0].find("movflags") == std::string::npos);
+    assert(commands[1].find("-c:v copy -c:a copy -c:s mov_text") != std::string::npos);
+    assert(commands[1].find("subtitles_track.ass") != std::string::npos);
+    assert(commands[1].find(opts.output) != std::string::npos);
+}
+
+void testVerseIndex() {
+    CLIOptions opts;
+    opts.surah = 2;
+    opts.from = 1;
+    opts.to = 2;
+    AppConfig cfg = loadConfig((getProjectRoot() / "config.json").string(), opts);
+    std::vector<VerseData> verses(3, makeSampleVerse());
+    verses[1].verseKey = "2:1";
+    verses[2].verseKey = "2:2";
+    verses[2].durationInSeconds = 4.0;
+
+    auto index = VerseIndex::build(opts, cfg, verses);
+    double lead = cfg.introDuration + cfg.pauseAfterIntroDuration;
+    assert(index.verses.size() == 3);
+    assert(std::abs(index.verses[1].start - (lead + 1.5)) < 1e-9);
+    assert(std::abs(index.verses[2].end - (lead + 7.0)) < 1e-9);
+
+    fs::path video = fs::temp_directory_path() / "verse_index_test.mp4";
+    VerseIndex::write(index, video);
+    assert(fs::exists(fs::temp_directory_path() / "verse_index_test.verses.json"));
+    assert(VerseIndex::load(video).verses.size() == 3);
+
+    // The leading Bismillah is skipped when matching verse numbers
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    fs::path extracted = VerseIndex::extract(video, 1, 2, "", mockProcessExecutor);
+    assert(extracted.filename() == "verse_index_test_1-2.mp4");
+    const auto& commands = mockProcessExecutor->getCommands();
+    assert(commands.size() == 1);
+    assert(commands[0].find("-c copy") != std::string::npos);
+    assert(commands[0].find("-t 5.500") != std::string::npos);
+
+    bool threw = false;
+    try { VerseIndex::extract(video, 2, 3, "", mockProcessExecutor); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw);
+    fs::remove(VerseIndex::sidecarPath(video));
+}
+
+void testOutputContainers() {
+    CLIOptions opts = makeRenderOptions("test_container.mp4");
+    AppConfig cfg = loadTestConfig(opts);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+
+    opts.container = "fmp4";
+    auto fragmented = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, fragmented);
+    assert(fragmented->getCommands().size() == 1);
+    assert(fragmented->getCommands()[0].find("frag_keyframe+empty_moov") != std::string::npos);
+    assert(fragmented->getCommands()[0].find("faststart") == std::string::npos);
+
+    opts.container = "hls";
+    auto hls = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, hls);
+    assert(hls->getCommands().size() == 1);
+    assert(hls->getCommands()[0].find("-f hls") != std::string::npos);
+    assert(hls->getCommands()[0].find("test_container/index.m3u8") != std::string::npos);
+    fs::remove_all(fs::temp_directory_path() / "test_container");
+}
+
+void testStreamUpload() {
+    CLIOptions opts = makeRenderOptions("test_upload.mp4");
+    opts.emitProgress = true;
+    opts.uploadKey = "renders/test_upload.mp4";
+    AppConfig cfg = loadTestConfig(opts);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+
+    // The encoder's stdout goes straight to the uploader; nothing is written locally
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    mockProcessExecutor->streamOutput = std::string(10000, 'v');
+    auto uploader = std::make_shared<MockStreamUploader>();
+    std::string result = VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor, nullptr, uploader);
+    assert(result == "renders/test_upload.mp4");
+    assert(uploader->key == "renders/test_upload.mp4");
+    assert(uploader->received == mockProcessExecutor->streamOutput);
+    const auto& commands = mockProcessExecutor->getCommands();
+    assert(commands.size() == 1);
+    assert(commands[0].find("empty_moov") != std::string::npos);
+    assert(commands[0].find("pipe:1") != std::string::npos);
+    assert(commands[0].find("-progress") == std::string::npos);
+    assert(!fs::exists(VideoGenerator::finalOutputPath(opts)));
+
+    auto failing = std::make_shared<MockStreamUploader>();
+    failing->succeed = false;
+    assert(VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor, nullptr, failing).empty());
+
+    // ffmpeg dying mid-encode must abort the upload, not publish the truncated video
+    auto crashed = std::make_shared<MockProcessExecutor>();
+    crashed->streamOutput = std::string(3000, 'v');
+    crashed->streamExitCode = 1;
+    auto aborted = std::make_shared<MockStreamUploader>();
+    assert(VideoGenerator::generateVideo(opts, cfg, verses, crashed, nullptr, aborted).empty());
+    assert(aborted->aborted && !aborted->published);
+    assert(aborted->received.size() == 3000);
+}
+
+void testDraftPreview() {
+    AppConfig landscape;
+    landscape.width = 1920;
+    landscape.height = 1080;
+    landscape.fps = 30;
+    AppConfig draft = VideoGenerator::draftConfig(landscape);
+    assert(draft.width == 640 && draft.height == 360 && draft.fps == 15);
+
+    AppConfig portrait = landscape;
+    portrait.width = 1080;
+    portrait.height = 1920;
+    draft = VideoGenerator::draftConfig(portrait);
+    assert(draft.width == 360 && draft.height == 640);
+
+    CLIOptions opts = makeRenderOptions("test_draft.mp4");
+    opts.draft = true;
+    AppConfig cfg = loadTestConfig(opts);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor);
+    AppConfig expected = VideoGenerator::draftConfig(cfg);
+    std::string scale = "scale=" + std::to_string(expected.width) + ":" + std::to_string(expected.height) +
+                        ",fps=" + std::to_string(expected.fps);
+    assert(mockProcessExecutor->getCommands().size() == 1);
+    assert(mockProcessExecutor->getCommands()[0].find(scale) != std::string::npos);
+    assert(VideoGenerator::finalOutputPath(opts).string().find(" - draft.mp4") != std::string::npos);
+}
+
+void testStillPreview() {
+    VerseIndex::Index index;
+    index.verses = {{"2:255", 10.0, 30.0}, {"2:256", 30.0, 31.0}};
+    assert(std::abs(VideoGenerator::resolveStillTime("12.5", index) - 12.5) < 1e-9);
+    assert(std::abs(VideoGenerator::resolveStillTime("2:255", index) - 11.0) < 1e-9);
+    assert(std::abs(VideoGenerator::resolveStillTime("2:256", index) - 30.5) < 1e-9);
+    bool threw = false;
+    try { VideoGenerator::resolveStillTime("2:300", index); } catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+    threw = false;
+    try { VideoGenerator::resolveStillTime("soon", index); } catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+
+    CLIOptions opts = makeRenderOptions("test_still.mp4");
+    AppConfig cfg = loadTestConfig(opts);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    std::string still = VideoGenerator::renderStill(opts, cfg, verses, mockProcessExecutor, nullptr, "1");
+    assert(fs::path(still).filename() == "test_still.png");
+    const auto& commands = mockProcessExecutor->getCommands();
+    assert(commands.size() == 1);
+    assert(commands[0].find("-frames:v 1") != std::string::npos);
+    assert(commands[0].find("setpts=PTS-STARTPTS+1.000/TB") != std::string::npos);
+    assert(commands[0].find("ass='") != std::string::npos);
+}
+
+void testStillBackground() {
+    CLIOptions opts = makeRenderOptions("test_still_bg.mp4");
+    AppConfig cfg = loadTestConfig(opts);
+    cfg.assetBgVideo = (fs::temp_directory_path() / "still_background.png").string();
+    std::vector<VerseData> verses = {makeSampleVerse()};
+
+    // An image background is decoded once and only frames around subtitle changes are kept
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor);
+    const std::string& command = mockProcessExecutor->getCommands()[0];
+    assert(command.find("-stream_loop") == std::string::npos);
+    assert(command.find("loop=loop=-1:size=1") != std::string::npos);
+    assert(command.find("select='not(mod(n,") != std::string::npos);
+    assert(command.find("+between(t,") != std::string::npos);
+    assert(command.find("-fps_mode vfr") != std::string::npos);
+
+    // Video backgrounds keep constant frame rate unless --static-bg asks otherwise
+    cfg.assetBgVideo = (fs::temp_directory_path() / "still_background.mp4").string();
+    auto looped = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, looped);
+    assert(looped->getCommands()[0].find("-fps_mode vfr") == std::string::npos);
+    opts.staticBackground = true;
+    auto forced = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, forced);
+    assert(forced->getCommands()[0].find("-fps_mode vfr") != std::string::npos);
+}
+
+void testLoopBuffer() {
+    AppConfig picture;
+    picture.width = 1280;
+    picture.height = 720;
+    picture.fps = 30;
+    picture.pixelFormat = "yuv420p";
+    // 10 s at 30 fps, 1.4 MB per frame: about 415 MB
+    assert(VideoGenerator::loopBufferFrames(10.0, picture, 1024) == 300);
+    assert(VideoGenerator::loopBufferFrames(10.0, picture, 256) == 0);
+    assert(VideoGenerator::loopBufferFrames(10.0, picture, 0) == 0);
+    assert(VideoGenerator::loopBufferFrames(0.0, picture, 1024) == 0);
+    picture.pixelFormat = "yuv420p10le";
+    assert(VideoGenerator::loopBufferFrames(10.0, picture, 512) == 0);
+}
+
+void testTextLayers() {
+    fs::path assPath = fs::temp_directory_path() / "text_layers_test.ass";
+    {
+        std::ofstream ass(assPath);
+        ass << "[Script Info]\nPlayResX: 1280\nPlayResY: 720\n\n[Events]\n"
+            << "Format: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n"
+            << "Dialogue: 0,0:00:01.00,0:00:05.00,Arabic,,0,0,0,,"
+            << "{\\an5\\fs60\\pos(640,300)\\fad(500,500)\\t(0,4000,\\fs72)}Text, with comma\n";
+    }
+    TextLayers::Plan plan = TextLayers::plan(assPath.string());
+
+    // Blank, fade in, growth steps, fade out, blank again; spans are contiguous from 0
+    assert(plan.timeline.front().start == 0.0);
+    assert(std::abs(plan.timeline.back().end - 5.0) < 1e-6);
+    for (size_t i = 1; i < plan.timeline.size(); ++i) {
+        assert(std::abs(plan.timeline[i].start - plan.timeline[i - 1].end) < 1e-9);
+        assert(plan.timeline[i].image != plan.timeline[i - 1].image);
+    }
+    assert(plan.images >= TextLayers::kGrowthSteps + 1);
+    assert(plan.sheet.find("\\t(") == std::string::npos);
+    assert(plan.sheet.find("\\fad(") == std::string::npos);
+    assert(plan.sheet.find("\\fade(") != std::string::npos);
+    assert(plan.sheet.find("Text, with comma") != std::string::npos);
+    fs::remove(assPath);
+
+    CLIOptions opts = makeRenderOptions("test_text_layers.mp4");
+    opts.prerenderText = true;
+    AppConfig cfg = loadTestConfig(opts);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor);
+    const auto& commands = mockProcessExecutor->getCommands();
+    assert(commands.size() == 2);
+    assert(commands[0].find("alpha=1") != std::string::npos);
+    assert(commands[1].find("layers.ffconcat") != std::string::npos);
+    assert(commands[1].find("overlay=eof_action=pass") != std::string::npos);
+    assert(commands[1].find("ass='") == std::string::npos);
+}
+
+void testThreadPolicy() {
+    // Quota files of a fake cgroup tree: v2 rounds partial cores up, "max" is unlimited
+    fs::path root = fs::temp_directory_path() / "qvm_cgroup_test";
+    fs::create_directories(root / "cpu");
+    std::ofstream(root / "cpu" / "cpu.cfs_quota_us") << "-1\n";
+    std::ofstream(root / "cpu" / "cpu.cfs_period_us") << "100000\n";
+    assert(ThreadPolicy::quotaCores(root) == 0);
+    std::ofstream(root / "cpu" / "cpu.cfs_quota_us") << "400000\n";
+    assert(ThreadPolicy::quotaCores(root) == 4);
+    std::ofstream(root / "cpu.max") << "250000 100000\n";
+    assert(ThreadPolicy::quotaCores(root) == 3);
+    std::ofstream(root / "cpu.max") << "max 100000\n";
+    assert(ThreadPolicy::quotaCores(root) == 0);
+    fs::remove_all(root);
+    assert(ThreadPolicy::availableCores() >= 1);
+
+    ThreadPolicy::Allocation wide = ThreadPolicy::allocate(32, 2);
+    assert(wide.filterThreads == 4 && wide.encoderThreads == 12);
+    assert(ThreadPolicy::threadsPerEncoder(wide, 3) == 4);
+    ThreadPolicy::Allocation single = ThreadPolicy::allocate(2, 4);
+    assert(single.filterThreads == 1 && single.encoderThreads == 1);
+    assert(ThreadPolicy::encoderArgs(wide, 1, true) == "-threads 12 -x264-params lookahead-threads=2 ");
+    assert(ThreadPolicy::encoderArgs(wide, 1, false) == "-threads 12 ");
+
+    CLIOptions opts = makeRenderOptions("test_thread_policy.mp4");
+    opts.threadsOverride = 8;
+    AppConfig cfg = loadTestConfig(opts);
+    assert(cfg.threads == 8 && cfg.jobs == 1);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor);
+    const std::string& command = mockProcessExecutor->getCommands().back();
+    assert(command.find("-threads 6 ") != std::string::npos);
+    assert(command.find("-filter_complex_threads 2 ") != std::string::npos);
+    assert(command.find("-threads 8 ") == std::string::npos);
+}
+
+void testDeadlinePlanner() {
+    fs::path historyPath = fs::temp_directory_path() / "qvm_history_test.jsonl";
+    fs::remove(historyPath);
+    auto entry = [](const std::string& source, const std::string& preset, double wall) {
+        RenderHistory::Entry e;
+        e.source = source;
+        e.preset = preset;
+        e.width = 1280;
+        e.height = 720;
+        e.fps = 30;
+        e.videoSeconds = 60.0;
+        e.wallSeconds = wall;
+        return e;
+    };
+    RenderHistory::append(historyPath, entry("render", "fast", 30.0));
+    RenderHistory::append(historyPath, entry("calibration", "fast", 10.0));
+    RenderHistory::append(historyPath, entry("render", "medium", 60.0));
+    std::ofstream(historyPath, std::ios::app) << "{\"preset\": \"slow\", \"wid\n";
+    auto history = RenderHistory::load(historyPath);
+    assert(history.size() == 3);
+    assert(std::abs(DeadlinePlanner::pixelRate(history, "fast", "render") - history[0].pixelRate()) < 1e-6);
+    assert(std::abs(DeadlinePlanner::pixelRate(history, "fast", "calibration") - history[1].pixelRate()) < 1e-6);
+
+    // A 60s job: fast takes 30s, medium 60s; the rest are calibrated (here: 4x slower per step)
+    // and scaled by fast's render/calibration ratio of 1/3
+    DeadlinePlanner::Job job{1280, 720, 30, 60.0};
+    std::vector<std::string> calibrated;
+    double fastRate = history[0].pixelRate();
+    auto calibrate = [&](const std::string& preset) {
+        calibrated.push_back(preset);
+        const auto& names = DeadlinePlanner::presets();
+        long step = std::find(names.begin(), names.end(), preset) - names.begin() - 4;
+        return fastRate / std::pow(4.0, static_cast<double>(step));
+    };
+    auto decision = DeadlinePlanner::choose(job, 45.0, history, calibrate);
+    assert(decision.preset == "fast" && decision.fits);
+    assert(std::abs(decision.estimatedSeconds - 30.0) < 1e-6);
+    assert(calibrated.size() <= 4);
+    decision = DeadlinePlanner::choose(job, 90.0, history, calibrate);
+    assert(decision.preset == "medium" && decision.basis == "history, 1 encode");
+    decision = DeadlinePlanner::choose(job, 0.01, history, calibrate);
+    assert(decision.preset == "ultrafast" && !decision.fits);
+    assert(std::abs(decision.estimatedSeconds - 30.0 * 3.0 / 256.0) < 1e-6);
+    assert(decision.basis == "calibration encode, scaled by renders of 'fast'");
+
+    // Without a calibration next to the renders, the rendered preset is calibrated to scale by
+    calibrated.clear();
+    decision = DeadlinePlanner::choose(job, 0.01, {history[0]}, calibrate);
+    assert(std::find(calibrated.begin(), calibrated.end(), "fast") != calibrated.end());
+    assert(std::abs(decision.estimatedSeconds - 30.0 / 256.0) < 1e-6);
+    assert(DeadlinePlanner::choose(job, 0.01, {history[0]}, nullptr).preset.empty());
+    assert(DeadlinePlanner::choose(job, 45.0, {}, nullptr).preset.empty());
+
+    // Calibration encodes synthetic video and records the result
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    double rate = DeadlinePlanner::calibrate("slow", job, "yuv420p", ThreadPolicy::allocate(4, 1),
+                                             mockProcessExecutor, historyPath);
+    assert(rate > 0.0);
+    assert(mockProcessExecutor->getCommands().back().find("testsrc2=s=1280x720") != std::string::npos);
+    assert(mockProcessExecutor->getCommands().back().find("-preset slow") != std::string::npos);
+    assert(RenderHistory::load(historyPath).back().source == "calibration");
+    fs::remove(historyPath);
+}
+
+void testRenderEstimate() {
+    auto entry = [](const std::string& source, int width, int height, double wall, double cpu, long rss) {
+        RenderHistory::Entry e;
+        e.source = source;
+        e.preset = "fast";
+        e.width = width;
+        e.height = height;
+        e.fps = 30;
+        e.videoSeconds = 60.0;
+        e.wallSeconds = wall;
+        e.inputs = 7;
+        e.cpuSeconds = cpu;
+        e.peakRssKb = rss;
+        return e;
+    };
+    std::vector<RenderHistory::Entry> history = {
+        entry("render", 1280, 720, 30.0, 120.0, 400000),
+        entry("render", 1280, 720, 40.0, 160.0, 420000),
+        entry("render", 1920, 1080, 90.0, 360.0, 800000),
+        entry("calibration", 1280, 720, 5.0, 0.0, 0)
+    };
+    assert(RenderHistory::Entry::fromJson(history[0].toJson()).peakRssKb == 400000);
+
+    // Twice the length at 720p: per-pixel medians of the three renders, memory of the 720p ones
+    RenderHistory::Entry job = entry("render", 1280, 720, 0.0, 0.0, 0);
+    job.videoSeconds = 120.0;
+    RenderHistory::Estimate estimate = RenderHistory::estimate(history, job);
+    assert(estimate.known && estimate.basis == "render" && estimate.samples == 3);
+    assert(std::abs(estimate.wallSeconds - 80.0) < 1e-6);
+    assert(std::abs(estimate.cpuSeconds - 320.0) < 1e-6);
+    assert(estimate.peakRssKb == 410000);
+
+    // Without renders the calibrations still give a wall time
+    history.erase(history.begin(), history.begin() + 3);
+    estimate = RenderHistory::estimate(history, job);
+    assert(estimate.known && estimate.basis == "calibration" && estimate.cpuSeconds == 0.0);
+    job.preset = "slow";
+    assert(!RenderHistory::estimate(history, job).known);
+
+    // Renders only predict jobs with the same text and background pipeline
+    RenderHistory::Entry layered = entry("render", 1280, 720, 10.0, 40.0, 300000);
+    layered.prerenderText = true;
+    assert(RenderHistory::Entry::fromJson(layered.toJson()).prerenderText);
+    history = {layered, entry("calibration", 1280, 720, 5.0, 0.0, 0)};
+    job.preset = "fast";
+    assert(RenderHistory::comparable(history, job).size() == 1);
+    assert(RenderHistory::estimate(history, job).basis == "calibration");
+    job.prerenderText = true;
+    assert(RenderHistory::estimate(history, job).basis == "render");
+
+    RenderHistory::Usage usage = RenderHistory::usage();
+    assert(usage.cpuSeconds >= 0.0 && usage.peakRssKb >= 0);
+}
+
+void testEncoderBackends() {
+    assert(EncoderBackends::isKnown("x265") && EncoderBackends::isKnown("svt-av1"));
+    assert(!EncoderBackends::isKnown("libx265"));
+    assert(EncoderBackends::svtPreset("fast") == "8" && EncoderBackends::svtPreset("4") == "4");
+
+    // x265 and AV1 stay in CRF mode: only the VBV caps are passed, never -b:v
+    ThreadPolicy::Allocation threads = ThreadPolicy::allocate(10, 1);
+    EncoderBackends::RateControl rate{26, "4500k", "6000k", "9000k"};
+    std::string hevc = EncoderBackends::videoArgs("x265", "medium", rate, threads, 2);
+    assert(hevc.find("-c:v libx265 -preset medium -crf 26 ") != std::string::npos);
+    assert(hevc.find("-b:v") == std::string::npos && hevc.find("-maxrate 6000k") != std::string::npos);
+    assert(hevc.find("-x265-params pools=4:") != std::string::npos);
+    std::string av1 = EncoderBackends::videoArgs("svt-av1", "fast", rate, threads, 1);
+    assert(av1.find("-c:v libsvtav1 -preset 8 -crf 26 ") != std::string::npos);
+    assert(av1.find("-svtav1-params lp=8:") != std::string::npos);
+    std::string x264 = EncoderBackends::videoArgs("software", "fast", rate, threads, 1);
+    assert(x264.find("-b:v 4500k") != std::string::npos && x264.find("-threads 8 ") != std::string::npos);
+
+    // The hevc profile switches the encoder unless --encoder was given
+    CLIOptions opts = makeRenderOptions("test_encoder_backends.mp4");
+    opts.qualityProfile = "hevc";
+    AppConfig cfg = loadTestConfig(opts);
+    assert(opts.encoder == "x265" && cfg.crf == 26);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+    auto mockProcessExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, mockProcessExecutor);
+    const std::string& command = mockProcessExecutor->getCommands().back();
+    assert(command.find("-c:v libx265") != std::string::npos);
+    assert(command.find("-tag:v hvc1") != std::string::npos);
+    assert(command.find("libx264") == std::string::npos);
+
+    // Soft subtitles: the Matroska picture goes untagged, the MP4 remux adds the tag
+    opts.softSubtitles = true;
+    auto softExecutor = std::make_shared<MockProcessExecutor>();
+    VideoGenerator::generateVideo(opts, cfg, verses, softExecutor);
+    const auto& softCommands = softExecutor->getCommands();
+    assert(softCommands.size() >= 2);
+    const std::string& pictureCommand = softCommands[softCommands.size() - 2];
+    assert(pictureCommand.find("-c:v libx265") != std::string::npos);
+    assert(pictureCommand.find(".mkv") != std::string::npos && pictureCommand.find("hvc1") == std::string::npos);
+    assert(softCommands.back().find("-c:v copy -tag:v hvc1") != std::string::npos);
+
+    CLIOptions pinned;
+    pinned.qualityProfile = "av1";
+    pinned.encoderProvided = true;
+    loadConfig((getProjectRoot() / "config.json").string(), pinned);
+    assert(pinned.encoder == "software");
+
+    // No encoded file from the mock: the result is reported as failed, not as numbers
+    auto benchExecutor = std::make_shared<MockProcessExecutor>();
+    auto measured = EncoderBackends::benchmark("sample.mp4", 10.0, "svt-av1", "fast", rate, "yuv420p", threads,
+                                               benchExecutor);
+    assert(!measured.ok && measured.bytes == 0);
+    assert(benchExecutor->getCommands().back().find("-i \"sample.mp4\" -map 0:v:0 -an -c:v libsvtav1") !=
+           std::string::npos);
+}
+
+void testVideoSelectorRanges() {
+    fs::path metadataPath = fs::temp_directory_path() / "selector_themes_test.json";
+    {
+        std::ofstream out(metadataPath);
+        out << R"({"_comment": "test", "19": {"16-33": ["maryam"], "1-15": ["dua"], "34-40": ["truth"]}})";
+    }
+
+    VideoSelector::Selector selector(metadataPath.string(), 7);
+    auto segments = selector.getVerseRangeSegments(19, 10, 36);
+    assert(segments.size() == 3);
+    assert(segments[0].rangeKey == "19:1-15");
+    assert(segments[0].startVerse == 10 && segments[0].endVerse == 15);
+    assert(segments[1].rangeKey == "19:16-33");
+    assert(segments[1].themes.size() == 1 && segments[1].themes[0] == "maryam");
+    assert(segments[2].startVerse == 34 && segments[2].endVerse == 36);
+    assert(segments.back().endTimeFraction == 1.0);
+
+    assert(selector.getVerseRangeSegments(19, 41, 50).empty());
+    assert(selector.getVerseRangeSegments(2, 1, 5).empty());
+    fs::remove(metadataPath);
+}
+
+void testBackgroundManifest() {
+    // Legacy entries are adopted by output key, then superseded once the source is known
+    auto manifest = BackgroundManifest::Manifest::fromJson(nlohmann::json::parse(
+        R"({"videos": [{"theme": "nature", "filename": "a_std.mp4", "duration": 4.5}]})"));
+    assert(manifest.findByOutput("nature/a_std.mp4") != nullptr);
+
+    BackgroundManifest::ClipEntry entry;
+    entry.theme = "nature";
+    entry.source = "nature/a.mov";
+    entry.sourceHash = CacheUtils::hashString("a");
+    entry.output = "nature/a_std.mp4";
+    entry.duration = 5.0;
+    manifest.upsert(entry);
+    assert(manifest.clips().size() == 1);
+    assert(manifest.findBySource("nature/a.mov")->sourceHash == entry.sourceHash);
+
+    auto reloaded = BackgroundManifest::Manifest::fromJson(manifest.toJson());
+    assert(reloaded.findBySource("nature/a.mov")->params == BackgroundManifest::OutputParams{});
+    assert(reloaded.totalDuration() == 5.0);
+
+    auto ladder = BackgroundManifest::parseLadder("1280x720, 1080x1920@25", 30, 23);
+    assert(ladder.size() == 2 && ladder[1].fps == 25 && ladder[1].crf == 23);
+    assert(BackgroundManifest::outputFilename("a", ladder[0], true) == "a_std.mp4");
+    assert(BackgroundManifest::outputFilename("a", ladder[1], false) == "a_std_1080x1920_25.mp4");
+    assert(BackgroundManifest::isRenditionVariant("a_std_1080x1920_25"));
+    assert(!BackgroundManifest::isRenditionVariant("a_std"));
+    bool rejected = false;
+    try {
+        BackgroundManifest::parseLadder("1280x", 30, 23);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+
+    entry.renditions.push_back({"nature/a_std_1080x1920_25.mp4", ladder[1]});
+    reloaded.upsert(entry);
+    reloaded = BackgroundManifest::Manifest::fromJson(reloaded.toJson());
+    const auto* vertical = reloaded.findByOutput("nature/a_std.mp4");
+    assert(vertical->ladder() == ladder);
+    assert(vertical->outputFor(1080, 1920, 25) == "nature/a_std_1080x1920_25.mp4");
+    assert(vertical->outputFor(1920, 1080, 30).empty());
+    assert(vertical->findRendition(1080, 1920, 25)->params.fps == 25);
+
+    BackgroundManifest::OutputParams aligned;
+    aligned.gopFrames = 30;
+    auto alignedEntry = entry;
+    alignedEntry.params = aligned;
+    reloaded.upsert(alignedEntry);
+    reloaded = BackgroundManifest::Manifest::fromJson(reloaded.toJson());
+    assert(reloaded.findBySource("nature/a.mov")->params.gopFrames == 30);
+    assert(reloaded.findBySource("nature/a.mov")->params != BackgroundManifest::OutputParams{});
+
+    auto dimmed = BackgroundManifest::withOverlays(ladder, {"0x000000@0.5"});
+    assert(dimmed.size() == 4 && dimmed[2].overlay == "0x000000@0.5" && dimmed[2].width == 1280);
+    std::string dimmedName = BackgroundManifest::outputFilename("a", dimmed[2], false);
+    assert(dimmedName == "a_std_1280x720_30_dim0x000000-0-5.mp4");
+    assert(BackgroundManifest::isRenditionVariant(fs::path(dimmedName).stem().string()));
+    entry.renditions.push_back({"nature/" + dimmedName, dimmed[2]});
+    assert(entry.outputFor(1280, 720, 30, "0x000000@0.5") == "nature/" + dimmedName);
+    assert(entry.outputFor(1280, 720, 30) == "nature/a_std.mp4");
+
+    assert(reloaded.prune({}, {"nature/a.mov"}) == 0);
+    assert(reloaded.prune({}, {}) == 1);
+    assert(reloaded.clips().empty());
+}
+
+void testRenderCache() {
+    CLIOptions opts;
+    opts.surah = 1;
+    opts.from = 1;
+    opts.to = 1;
+    AppConfig cfg = loadConfig((getProjectRoot() / "config.json").string(), opts);
+    std::vector<VerseData> verses = {makeSampleVerse()};
+
+    auto first = RenderCache::compute(opts, cfg, verses);
+    assert(first.id == RenderCache::compute(opts, cfg, verses).id);
+    verses[0].translation = "changed";
+    assert(first.id != RenderCache::compute(opts, cfg, verses).id);
+    opts.preset = "slow";
+    assert(first.id != RenderCache::compute(opts, cfg, {makeSampleVerse()}).id);
+
+    fs::path store = fs::temp_directory_path() / "qvm_render_store_test";
+    fs::remove_all(store);
+    assert(!RenderCache::lookup(store, first.id));
+    fs::path video = fs::temp_directory_path() / "qvm_render_cache_video.mp4";
+    {
+        std::ofstream out(video, std::ios::binary);
+        out << "not really a video";
+    }
+    assert(RenderCache::save(store, first, video));
+    auto cached = RenderCache::lookup(store, first.id);
+    assert(cached);
+    fs::path restored = store / "restored" / "out.mp4";
+    assert(RenderCache::restore(*cached, restored));
+    assert(fs::file_size(restored) == fs::file_size(video));
+    // The restored video is a copy; changing it leaves the store entry intact
+    {
+        std::ofstream out(restored, std::ios::binary | std::ios::app);
+        out << " edited";
+    }
+    assert(fs::file_size(*cached) == fs::file_size(video));
+    fs::remove_all(store);
+    fs::remove(video);
+}
+
 void testGenerateBackendMetadata() {
     fs::path tempDir = "temp_backend_metadata";
     fs::path tempPath = tempDir / "backend-metadata-test.json";
@@ -272,9 +998,29 @@ void testGenerateBackendMetadata() {
 
 int main() {
     fs::current_path(getProjectRoot());
+    // Cached openings, audio tracks and pictures must not land in the user's cache
+    fs::path cacheRoot = fs::temp_directory_path() / "qvm_unit_test_cache";
+    fs::remove_all(cacheRoot);
+    CacheUtils::setCacheRoot(cacheRoot);
     testApi();
     testMetadataWriter();
     testVideoGenerator();
+    testOpeningSegment();
+    testRenditions();
+    testTranslationVariants();
+    testSoftSubtitles();
+    testVerseIndex();
+    testOutputContainers();
+    testStreamUpload();
+    testDraftPreview();
+    testStillPreview();
+    testStillBackground();
+    testLoopBuffer();
+    testTextLayers();
+    testThreadPolicy();
+    testDeadlinePlanner();
+    testRenderEstimate();
+    testEncoderBackends();
     testConfigLoader();
     testCacheUtils();
     testLocalization();
@@ -283,7 +1029,11 @@ int main() {
     testSubtitleBuilder();
     testTextLayoutEngine();
     testCustomAudioPlan();
+    testVideoSelectorRanges();
+    testBackgroundManifest();
+    testRenderCache();
     testGenerateBackendMetadata();
+    fs::remove_all(cacheRoot);
     std::cout << "All unit tests passed.\n";
     return 0;
 }